@@ -8,6 +8,10 @@
 #include "src/ComponentSystem/StandardComponents.hpp"
 #include "src/ComponentSystem/EngineComponents.hpp"
 #include "src/ComponentSystem/Renderer.hpp"
+#include "src/ComponentSystem/TextureHotReload.hpp"
+#include "src/Input/InputSystem.hpp"
+#include "src/Render/PixelConvert.hpp"
+#include "src/Utility/AssetPack.hpp"
 
 #pragma comment(lib, "SDL2_image.lib")
 //#pragma comment(lib, "SDL2_mixer.lib")
@@ -67,7 +71,7 @@ public:
 	[[noreturn]] void draw2D() noexcept override {}
 	[[noreturn]] void draw3D() noexcept override {}
 private:
-	//!@brief 摜̃T[tFCX̍쐬
+	//!@brief 画像のサーフェイスの作成
 	[[nodiscard]] SDL_Surface* LoadSurface(const std::string& filePath) const noexcept
 	{
 		//final optimized image
@@ -95,8 +99,8 @@ private:
 		}
 		return optimizedSurface;
 	}
-	//!@brief 摜`ΉĂ邩`FbN
-	//!@return true:Ή  false:ΉĂȂ
+	//!@brief 画像形式が対応しているかチェック
+	//!@return true:対応  false:対応していない
 	[[nodiscard]] const bool CheckImageFormat() const noexcept
 	{
 		SDL_RWops* rwop = SDL_RWFromFile(path.c_str(), "rb");
@@ -142,12 +146,14 @@ public:
 		colorData = Vector3(1, 1, 1);
 		renderer = &entity->getComponent<ECS::RendererSystem>();
 		texList = &entity->getComponent<ECS::AssetTexture>();
+		//追い出された texture はここから読み込み直される
+		texList->setLoader([this](const std::string& filePath) { return load(filePath); });
 	}
 	[[noreturn]] void update() noexcept override {}
 	[[noreturn]] void draw2D() noexcept override {}
 	[[noreturn]] void draw3D() noexcept override {}
 private:
-	[[nodiscard]] SDL_Texture& process(const std::string& filePath) const noexcept
+	[[nodiscard]] SDL_Texture* process(const std::string& filePath) const noexcept
 	{
 		SDL_Texture* newTexture = nullptr;
 		SDL_Surface* loadSurface = IMG_Load(filePath.c_str());
@@ -160,51 +166,85 @@ private:
 			//color key image
 			SDL_SetColorKey(loadSurface, colorKey, SDL_MapRGB(loadSurface->format, 
 				(Uint8)colorData.xValue, (Uint8)colorData.yValue, (Uint8)colorData.zValue));
+			//convert to the texture format (color key becomes alpha)
+			SDL_Surface* normalSurface = Render::NormalizeSurface(loadSurface, premultiplied);
+			//old load surface free
+			SDL_FreeSurface(loadSurface);
+			if (normalSurface == nullptr)
+			{
+				SDL_PrintError(normalSurface);
+				return nullptr;
+			}
 			//create texture from surface pixels
-			newTexture = SDL_CreateTextureFromSurface(&renderer->GetRenderer(), loadSurface);
+			newTexture = Render::CreateTexture(&renderer->GetRenderer(), normalSurface, premultiplied);
 			if (newTexture == nullptr)
 			{
 				SDL_PrintError(newTexture);
 			}
-			//old load surface free
-			SDL_FreeSurface(loadSurface);
+			SDL_FreeSurface(normalSurface);
+		}
+		return newTexture;
+	}
+	//!@brief パックにあればデコードせずにそこから、なければファイルから texture を作る
+	[[nodiscard]] SDL_Texture* load(const std::string& filePath)
+	{
+		//パックの画像にはカラーキーがかかっていない
+		if (!colorKey)
+		{
+			if (SDL_Texture* texture = pack.createTexture(&renderer->GetRenderer(), filePath, premultiplied))
+			{
+				return texture;
+			}
 		}
-		return *newTexture;
+		return process(filePath);
 	}
 public:
-	//!@brief [name]keyƂ[filePath]o^
+	//!@brief [filePath]のパックを開きます。以降はパックにある画像をパックから読み込みます
+	//!@return true:開けた  false:パックがない(ファイルから読み込みます)
+	bool openPack(const std::string& filePath)
+	{
+		return pack.open(filePath);
+	}
+	//!@brief [name]をkeyとして[filePath]を登録する
 	[[noreturn]] void regist(const std::string& name,const std::string& filePath) noexcept
 	{
-		SDL_Texture* texture = &process(filePath);
 		registName = name;
-		texList->regist(name, texture);
+		texList->registFile(name, filePath);
 	}
-	//!@brief J[L[COݒ(wiȉ摜ȂǂɎgp)
+	//!@brief カラーキーイングを設定(背景が透明な画像などに使用)
 	[[noreturn]] void setColorKey(const bool isColorKey,const Vector3& color)
 	{
 		colorKey = isColorKey;
 		colorData = color;
 	}
-	//!@brief texture̐FZ܂
+	//!@brief 以降に読み込む画像を乗算済みアルファにするか設定します(既定は false)
+	//!@note 乗算済みの texture は専用のブレンドモードで描画するので、BlendMode は追加しないでください
+	[[noreturn]] void setPremultipliedAlpha(const bool isPremultiplied) noexcept
+	{
+		premultiplied = isPremultiplied;
+	}
+	//!@brief textureの色を乗算します
 	[[noreturn]] void setMultiColor(const Vector3& multiColor)
 	{
 		SDL_SetTextureColorMod(texList->getTexture(registName),
 			static_cast<Uint8>(multiColor.xValue), static_cast<Uint8>(multiColor.yValue), static_cast<Uint8>(multiColor.zValue));
 	}
-	//!@brief o^[key]擾
+	//!@brief 登録した[key]を取得する
 	[[nodiscard]] const ECS::AssetTexture::KeyTypeData& getKey() const noexcept
 	{
 		return registName;
 	}
-	//!@brief o^[key][value]擾
-	[[nodiscard]] const ECS::AssetTexture::ValueTypeData& getValue() const noexcept
+	//!@brief 登録した[key]の[value]を取得する
+	[[nodiscard]] ECS::AssetTexture::ValueTypeData getValue() const noexcept
 	{
 		return texList->getTexture(registName);
 	}
 private:
 	ECS::RendererSystem* renderer;
 	ECS::AssetTexture* texList;
+	AssetPack pack;
 	bool colorKey = false;
+	bool premultiplied = false;
 	std::string registName;
 	Vector3 colorData;
 };
@@ -212,66 +252,20 @@ private:
 
 
 
-class InputSystem
-{
-public:
-	enum class Key : Uint32
-	{
-		A = SDLK_a,
-		B = SDLK_b,
-		C = SDLK_c,
-		D = SDLK_d,
-		E = SDLK_e,
-		F = SDLK_f,
-		G = SDLK_g,
-		H = SDLK_h,
-		I = SDLK_i,
-		J = SDLK_j,
-		K = SDLK_k,
-		L = SDLK_l,
-		M = SDLK_m,
-		N = SDLK_n,
-		O = SDLK_o,
-		P = SDLK_p,
-		Q = SDLK_q,
-		R = SDLK_r,
-		S = SDLK_s,
-		T = SDLK_t,
-		U = SDLK_u,
-		V = SDLK_v,
-		W = SDLK_w,
-		X = SDLK_x,
-		Y = SDLK_y,
-		Z = SDLK_z,
-	};
-	void update()
-	{
-		while (SDL_PollEvent(&inputEvent) != 0)
-		{
-			if (inputEvent.type == SDL_QUIT)
-			{
-				pushFlag = true;
-			}
-		}
-	}
-	bool push()
-	{
-		return pushFlag;
-	}
-private:
-	SDL_Event inputEvent;
-	bool pushFlag = false;
-};
-
 namespace ECS
 {
 	
 }
 
 
-int main(int /*argc*/, char** /*argv*/)
+int main(int argc, char** argv)
 {
+	//--headless なら描画せずにシミュレーションだけを行う(WindowSystem を追加する前に決める)
+	Runtime::get().parseArgs(argc, argv);
 	ECS::EntitySystemManager::get().initialize();
+	//600フレームごとにメモリの使用量を書き出す
+	Memory::MemoryTracker::get().setDumpInterval(600, "memory.log");
+	Telemetry::FrameTelemetry::get().setDumpInterval(600, "telemetry.prom");
 
 	std::unique_ptr<ECS::EntityManager> deviceManager = std::make_unique<ECS::EntityManager>();
 	ECS::EntitySystemManager::get().regist("engine", deviceManager);
@@ -283,14 +277,23 @@ int main(int /*argc*/, char** /*argv*/)
 	deviceEntity->addComponent<ECS::WindowSystem>();
 	deviceEntity->addComponent<ECS::RendererSystem>();
 	deviceEntity->addComponent<ECS::AssetTexture>();
-	deviceEntity->addComponent<CreateTexture>().regist("samp","Resource/test.bmp");
+	deviceEntity->addComponent<ECS::AssetFont>();
+	//tools/AssetPacker で作ったパックがあればそこから読み込む
+	deviceEntity->addComponent<CreateTexture>().openPack("Resource/assets.vpak");
+	deviceEntity->getComponent<CreateTexture>().regist("samp","Resource/test.bmp");
 	deviceEntity->getComponent<CreateTexture>().regist("te", "Resource/sample.png");
 	deviceEntity->getComponent<CreateTexture>().regist("anim", "Resource/anim.png");
+#ifdef _DEBUG
+	//画像を書き換えたら再起動しなくても反映する
+	deviceEntity->addComponent<ECS::TextureHotReload>();
+#endif
 	deviceEntity->addGroup(ENTITY_GROUP::Engine);
 
 	//gameManager
 	std::unique_ptr<ECS::EntityManager> gameManager = std::make_unique<ECS::EntityManager>();
 	ECS::EntitySystemManager::get().regist("game", gameManager);
+	//game は engine の renderer や texture を使うので、engine の後に更新する
+	ECS::EntitySystemManager::get().addDependency("game", "engine");
 	ECS::EntityManager* game = &ECS::EntitySystemManager::get().getEntityManager("game");
 	
 	//rect
@@ -302,20 +305,21 @@ int main(int /*argc*/, char** /*argv*/)
 	entity->addComponent<ECS::SpriteSheetRenderer>(120, 5);
 	entity->addComponent<ECS::RotationTexture>(-30.0f, Vector2(0, 0));
 
-	//renderer (ŌłȂƃoO)
+	//renderer (最後でないとバグる)
 	ECS::Entity* render = &game->addEntity();
 	render->addComponent<ECS::Renderer>();
 	render->addGroup(ENTITY_GROUP::Engine);
 
-	InputSystem input;
+	Input::InputSystem& input = Input::InputSystem::get();
 	while(1)
 	{
-		ECS::EntitySystemManager::get().update();
+		//入力はフレームの先頭で読む(ECSの更新で1フレーム遅れないように)
 		input.update();
-		if (input.push())
+		if (input.push() || Runtime::get().isFinished())
 		{
 			break;
 		}
+		ECS::EntitySystemManager::get().update();
 	}
 	return 0;
 }
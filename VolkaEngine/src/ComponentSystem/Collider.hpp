@@ -1,6 +1,6 @@
 //---------------------------------------------------------
 //!@file Collider.hpp
-//!@brief Collider܂
+//!@brief Colliderを扱います
 //!@author Volka
 //!@date 2018/11/3
 //---------------------------------------------------------
@@ -21,14 +21,29 @@ namespace ECS
 				entity->addComponent<Position>();
 			}
 			pos = &entity->getComponent<Position>();
+			observeSiblings();
+		}
+		//!@brief Position が削除されたら nullptr にし、付け直されたら取り直します
+		void onComponentAdded(const ComponentID id) override
+		{
+			rebind(pos, id);
+		}
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(pos, id);
 		}
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
 	public:
-		[[noreturn]] void offset(const Vector2& offset) noexcept
+		void offset(const Vector2& offset) noexcept
 		{
+			if (pos == nullptr)
+			{
+				return;
+			}
 			pos->position.offset(offset.xValue, offset.yValue, 0.0f);
+			entity->markChanged<Position>();
 		}
 		[[nodiscard]] const Vector2& offsetCopy(const Vector2& offset) const noexcept
 		{
@@ -51,14 +66,29 @@ namespace ECS
 				entity->addComponent<Position>();
 			}
 			pos = &entity->getComponent<Position>();
+			observeSiblings();
+		}
+		//!@brief Position が削除されたら nullptr にし、付け直されたら取り直します
+		void onComponentAdded(const ComponentID id) override
+		{
+			rebind(pos, id);
+		}
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(pos, id);
 		}
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
 	public:
-		[[noreturn]] void offset(const Vector3& offset) noexcept
+		void offset(const Vector3& offset) noexcept
 		{
+			if (pos == nullptr)
+			{
+				return;
+			}
 			pos->position.offset(offset.xValue, offset.yValue, offset.zValue);
+			entity->markChanged<Position>();
 		}
 		[[nodiscard]] const Vector2& offsetCopy(const Vector3& offset) const noexcept
 		{
@@ -78,6 +108,16 @@ namespace ECS
 				entity->addComponent<Position>();
 			}
 			pos = &entity->getComponent<Position>();
+			observeSiblings();
+		}
+		//!@brief Position が削除されたら nullptr にし、付け直されたら取り直します
+		void onComponentAdded(const ComponentID id) override
+		{
+			rebind(pos, id);
+		}
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(pos, id);
 		}
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override {}
@@ -96,6 +136,16 @@ namespace ECS
 				entity->addComponent<Position>();
 			}
 			pos = &entity->getComponent<Position>();
+			observeSiblings();
+		}
+		//!@brief Position が削除されたら nullptr にし、付け直されたら取り直します
+		void onComponentAdded(const ComponentID id) override
+		{
+			rebind(pos, id);
+		}
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(pos, id);
 		}
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override {}
@@ -1,16 +1,29 @@
 //---------------------------------------------------------
 //!@file EngineComponents.hpp
-//!@brief WIȃGWComponentQpӂ܂
+//!@brief 標準的なエンジン側のComponent群を用意します
 //!@author Volka
 //!@date 2018/11/3
-//!@note window, renderer Ȃ
+//!@note window, renderer など
 //---------------------------------------------------------
 #pragma once
 #include <SDL.h>
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <typeinfo>
 #include <SDL2_image/SDL_image.h>
 #include "../ComponentSystem/StandardComponents.hpp"
+#include "../Event/EventBus.hpp"
+#include "../Event/Events.hpp"
+#include "../Render/RenderCommand.hpp"
+#include "../Render/RenderThread.hpp"
+#include "../Render/DrawScene.hpp"
+#include "../Render/Camera.hpp"
+#include "../Render/DirtyRegion.hpp"
+#include "../Render/BitmapFont.hpp"
+#include "../Utility/Runtime.hpp"
 
 #pragma comment(lib, "SDL2.lib")
 #pragma comment(lib, "SDL2main.lib")
@@ -25,6 +38,16 @@
 #define SDL_RENDERER_FLAGS (0)
 #endif
 
+/** NOTE: 描画は SDL_Renderer を作ったメインスレッドで行います(SDL2 の描画APIは作ったスレッドでしか使えません)。
+	ワールドの更新はワーカーで行うので、前のフレームの描画と次のフレームの更新はどのプラットフォームでも重なります。
+	VOLKA_RENDER_THREAD を定義すると描画を専用のスレッドで行います。
+	Direct3D やソフトウェアなど、スレッドをまたいでも動くバックエンドだけで使ってください(OpenGL では使えません) */
+#ifdef VOLKA_RENDER_THREAD
+#define VOLKA_RENDER_THREADED (true)
+#else
+#define VOLKA_RENDER_THREADED (false)
+#endif
+
 #define ENTITY_GROUP (ECS::Group)ECS::EntityGroup
 
 namespace ECS
@@ -34,15 +57,24 @@ namespace ECS
 		Engine,
 	};
 	//!@class WindowSystem
+	//!@note ヘッドレス(Runtime::isHeadless())ではウィンドウを作らず、画面の大きさの surface だけを用意します
+	//!@note RendererSystem より先に追加してください(Componentは追加の逆順に解放されるので、描画が止まってから破棄されます)
 	class WindowSystem final : public ECS::ComponentSystem
 	{
 	public:
 		virtual ~WindowSystem()
 		{
-			SDL_DestroyWindow(window);
+			if (window != nullptr)
+			{
+				SDL_DestroyWindow(window);
+			}
+			else
+			{
+				SDL_FreeSurface(surface);
+			}
 			SDL_Quit();
 		}
-		[[noreturn]] void initialize() noexcept override
+		void initialize() noexcept override
 		{
 			if (!entity->hasComponent<ECS::Screen>())
 			{
@@ -54,6 +86,15 @@ namespace ECS
 				entity->addComponent<ECS::Color>((Uint8)0x00, (Uint8)0xFF, (Uint8)0xFF, (Uint8)0xFF);
 			}
 			color = &entity->getComponent<ECS::Color>();
+			if (Runtime::get().isHeadless())
+			{
+				//ディスプレイのない環境でも動くように、映像と音声は初期化しない
+				if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0) {
+					//SDL_PrintError(SDL_Init);
+				}
+				createHeadless();
+				return;
+			}
 			if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
 				//SDL_PrintError(SDL_Init);
 			}
@@ -63,17 +104,30 @@ namespace ECS
 		[[noreturn]] void draw2D() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
 	public:
-		//!@brief window̎擾
+		//!@brief windowの取得
+		//!@note ヘッドレスでは使えません(hasWindow() で確認してください)
 		[[nodiscard]] SDL_Window& GetWindow() const noexcept
 		{
 			return *window;
 		}
-		//!@brief surface̎擾
+		//!@brief surfaceの取得
 		[[nodiscard]] SDL_Surface& GetSurface() const noexcept
 		{
 			return *surface;
 		}
+		//!@brief windowがあるか(ヘッドレスでは false)
+		[[nodiscard]] bool hasWindow() const noexcept
+		{
+			return window != nullptr;
+		}
 	private:
+		//!@brief windowの代わりに画面の大きさの surface を作ります
+		[[noreturn]] void createHeadless() noexcept
+		{
+			window = nullptr;
+			surface = SDL_CreateRGBSurfaceWithFormat(0,
+				static_cast<int>(screen->size.xValue), static_cast<int>(screen->size.yValue), 32, SDL_PIXELFORMAT_ARGB8888);
+		}
 		[[noreturn]] void createWindow() noexcept
 		{
 			window = SDL_CreateWindow(screen->screenName.c_str(),
@@ -97,45 +151,306 @@ namespace ECS
 			}
 		}
 	private:
-		SDL_Window* window;
-		SDL_Surface* surface;
+		SDL_Window* window = nullptr;
+		SDL_Surface* surface = nullptr;
 		ECS::Screen* screen;
 		ECS::Color* color;
 	};
 
 
 	//!@class RendererSystem
+	//!@brief SDL_Renderer と描画スレッドを持ち、1フレーム分のコマンドリストを管理します
+	//!@note 描画スレッドは VOLKA_RENDER_THREAD を定義したときだけ使います(既定はメインスレッドで、次のフレームの更新と並行して描画)
+	//!@note update() はワーカーで呼ばれるので、そこから SDL を触るときは invoke() を通してください
+	//!@note ヘッドレスでは WindowSystem の surface に描くソフトウェアレンダラーを作り、描画スレッドは使いません
+	//!@note (texture の作成などはそのまま動きますが、draw2D/draw3D が呼ばれないので present() されません)
 	class RendererSystem final : public ECS::ComponentSystem
 	{
+	public:
+		//1フレームに予定するコマンド数
+		static constexpr std::size_t ReserveCommandNum = 256;
+		//1フレームに予定するカメラの数
+		static constexpr std::size_t ReserveCameraNum = 8;
 	public:
 		virtual ~RendererSystem()
 		{
+			renderThread.stop();
 			SDL_DestroyRenderer(renderer);
 		}
 		[[noreturn]] void initialize() noexcept override
 		{
 			window = &entity->getComponent<WindowSystem>();
 			color = &entity->getComponent<Color>();
-			renderer = SDL_CreateRenderer(&window->GetWindow(), -1, SDL_RENDERER_FLAGS);
+			screen = &entity->getComponent<Screen>();
+			hasViewport = false;
+			viewport = { 0, 0, 0, 0 };
+			dirtyRectMode = false;
+			if (window->hasWindow())
+			{
+				renderer = SDL_CreateRenderer(&window->GetWindow(), -1, SDL_RENDERER_FLAGS);
+			}
+			else
+			{
+				renderer = SDL_CreateSoftwareRenderer(&window->GetSurface());
+			}
 			if (renderer == nullptr)
 			{
 				//SDL_PrintError(SDL_CreateRenderer);
 				SDL_Quit();
 			}
 			SDL_SetRenderDrawColor(renderer, color->value.xValue, color->value.yValue, color->value.zValue, color->value.wValue);
+			for (auto& list : commandLists)
+			{
+				list.reserve(ReserveCommandNum);
+			}
+			//毎フレーム作り直すリストは clear() で容量を残して使い回し、定常状態ではヒープ確保しない
+			visibleList.reserve(ReserveCommandNum);
+			cameras.reserve(ReserveCameraNum);
+			sceneCommands.reserve(ReserveCommandNum);
+			dirtyRects.reserve(Render::DirtyRegionTracker::MaxRectNum + 1);
+			writeIndex = 0;
+			recording = false;
+			listFrame = 0;
+			renderThread.start(renderer, VOLKA_RENDER_THREADED && window->hasWindow());
 		}
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
 	public:
+		//!@brief SDL_Renderer を直接取得します
+		//!@note 描画と同時に触らないように、フレームの途中では invoke() の中で使ってください
 		[[nodiscard]] SDL_Renderer& GetRenderer() const noexcept
 		{
 			return *renderer;
 		}
+		//!@brief 今フレームのコマンドリストを取得します
+		//!@brief フレームで最初の呼び出しでリストを空にし、先頭に Clear を積みます
+		//!@note リストは2つを交互に使い、片方を描画スレッドが読んでいる間にもう片方へ積みます
+		[[nodiscard]] Render::RenderCommandList& getCommandList()
+		{
+			const std::uint64_t frame = Memory::FrameAllocator::get().getFrameCount();
+			//前のフレームで提出されなかったコマンドは捨てる
+			if (!recording || listFrame != frame)
+			{
+				Render::RenderCommandList& list = commandLists[writeIndex];
+				list.clear();
+				Render::RenderCommand clear;
+				clear.type = Render::CommandType::Clear;
+				clear.color = { color->value.xValue, color->value.yValue, color->value.zValue, color->value.wValue };
+				list.push(clear);
+				listFrame = frame;
+				recording = true;
+			}
+			return commandLists[writeIndex];
+		}
+		//!@brief コマンドを1つ積みます
+		void push(const Render::RenderCommand& command)
+		{
+			getCommandList().push(command);
+		}
+		//!@brief ビューポートを設定します(間引きもこの範囲で行います)
+		void setViewport(const SDL_Rect& rect) noexcept
+		{
+			viewport = rect;
+			hasViewport = true;
+		}
+		//!@brief 今フレームで使うカメラを追加します(Presentのたびに空になります)
+		void addCamera(const Render::CameraView& camera)
+		{
+			cameras.emplace_back(camera);
+		}
+		//!@brief 見えているプロキシと Present を積んで、今フレームのリストを描画スレッドへ渡します
+		//!@brief カメラがあるときはカメラごとに間引いて、変換したコマンドを積みます
+		//!@note 前のフレームの描画が終わっていなければ待ちます
+		void present()
+		{
+			Render::RenderCommand command;
+			auto& scene = Render::DrawScene::get();
+			if (cameras.empty())
+			{
+				SDL_Rect view = { 0, 0, static_cast<int>(screen->size.xValue), static_cast<int>(screen->size.yValue) };
+				if (hasViewport)
+				{
+					command.type = Render::CommandType::Viewport;
+					command.dst = viewport;
+					push(command);
+					//ビューポート内の座標は左上が原点
+					view = { 0, 0, viewport.w, viewport.h };
+				}
+				visibleList.clear();
+				scene.collect(view, visibleList);
+				for (const Render::ProxyID id : visibleList)
+				{
+					pushDraw(scene.getProxy(id).command, nullptr);
+				}
+			}
+			else
+			{
+				std::stable_sort(cameras.begin(), cameras.end(), [](const Render::CameraView& a, const Render::CameraView& b)
+				{
+					return a.order < b.order;
+				});
+				for (const auto& camera : cameras)
+				{
+					command.type = Render::CommandType::Viewport;
+					command.dst = camera.viewport;
+					push(command);
+					visibleList.clear();
+					scene.collect(camera.getWorldBounds(), visibleList);
+					for (const Render::ProxyID id : visibleList)
+					{
+						pushDraw(scene.getProxy(id).command, &camera);
+					}
+				}
+				cameras.clear();
+			}
+			scene.endFrame();
+			if (dirtyRectMode)
+			{
+				buildDirtyRectList();
+			}
+			else
+			{
+				command.type = Render::CommandType::Present;
+				push(command);
+			}
+			renderThread.submit(commandLists[writeIndex]);
+			writeIndex ^= 1;
+			recording = false;
+		}
+		//!@brief 描画スレッドが渡したリストを実行し終わるまで待ちます
+		void waitIdle()
+		{
+			renderThread.waitIdle();
+		}
+		//!@brief [task]を描画と重ならないように、SDL_Renderer を使えるスレッドで実行します
+		//!@note texture の作成・破棄など SDL を触る処理はこの中で行います(ワーカーから呼ぶとメインスレッドで実行して待ちます)
+		void invoke(const std::function<void()>& task)
+		{
+			renderThread.invoke(task);
+		}
+		//!@brief 変わった領域だけを描き直すモードを設定します
+		//!@note 前のフレームの画面が残るソフトウェアレンダラでだけ有効にできます
+		//!@return true:設定できた  false:ソフトウェアレンダラではない
+		bool setDirtyRectMode(const bool enable)
+		{
+			if (enable)
+			{
+				SDL_RendererInfo info;
+				if (SDL_GetRendererInfo(renderer, &info) != 0 || (info.flags & SDL_RENDERER_SOFTWARE) == 0)
+				{
+					return false;
+				}
+				dirtyTracker.resize(static_cast<int>(screen->size.xValue), static_cast<int>(screen->size.yValue));
+			}
+			dirtyRectMode = enable;
+			return true;
+		}
+		//!@brief 次のフレームは画面全体を描き直します(textureの中身を書き換えたときなど)
+		void invalidateScreen() noexcept
+		{
+			dirtyTracker.invalidate();
+		}
+		//!@brief 直前のフレームで描き直した領域の割合
+		[[nodiscard]] float getDirtyRatio() const noexcept
+		{
+			return dirtyTracker.getDirtyRatio();
+		}
+	private:
+		//!@brief プロキシのコマンドを[camera]で変換して積みます(nullptrなら変換しない)
+		//!@brief ジオメトリはここで頂点をリストへ書き込ませます
+		void pushDraw(const Render::RenderCommand& command, const Render::CameraView* camera)
+		{
+			Render::RenderCommand result = camera != nullptr ? camera->transform(command) : command;
+			if (result.type == Render::CommandType::Geometry)
+			{
+				const std::size_t count = command.geometry->getVertexCount(command.part);
+				if (count == 0)
+				{
+					return;
+				}
+				SDL_Vertex* vertices = getCommandList().allocateVertices(count, result.first);
+				command.geometry->writeVertices(command.part, vertices);
+				result.count = static_cast<std::uint32_t>(count);
+				if (camera != nullptr)
+				{
+					camera->transformVertices(vertices, count);
+				}
+			}
+			push(result);
+		}
+		//!@brief 今フレームのリストを、変わった矩形だけを描き直すリストに作り替えます
+		void buildDirtyRectList()
+		{
+			Render::RenderCommandList& list = commandLists[writeIndex];
+			//先頭の Clear は背景色として使う
+			const SDL_Color clearColor = list.begin()->color;
+			sceneCommands.assign(list.begin() + 1, list.end());
+			dirtyTracker.update(sceneCommands.data(), sceneCommands.data() + sceneCommands.size(), clearColor, dirtyRects);
+			//ジオメトリの頂点はそのまま使う
+			list.clearCommands();
+			const SDL_Rect full = { 0, 0, static_cast<int>(screen->size.xValue), static_cast<int>(screen->size.yValue) };
+			Render::RenderCommand command;
+			for (const auto& rect : dirtyRects)
+			{
+				command = Render::RenderCommand();
+				command.type = Render::CommandType::Viewport;
+				command.dst = full;
+				list.push(command);
+				command.type = Render::CommandType::SetClip;
+				command.dst = rect;
+				list.push(command);
+				command.type = Render::CommandType::FillRect;
+				command.color = clearColor;
+				list.push(command);
+				SDL_Rect current = full;
+				for (const auto& sceneCommand : sceneCommands)
+				{
+					if (sceneCommand.type == Render::CommandType::Viewport)
+					{
+						current = sceneCommand.dst;
+						list.push(sceneCommand);
+						continue;
+					}
+					SDL_Rect bounds = Render::GetCommandBounds(sceneCommand);
+					bounds.x += current.x;
+					bounds.y += current.y;
+					if (Render::IsOverlap(bounds, rect))
+					{
+						list.push(sceneCommand);
+					}
+				}
+			}
+			if (dirtyRects.empty())
+			{
+				return;
+			}
+			command = Render::RenderCommand();
+			command.type = Render::CommandType::SetClip;
+			list.push(command);
+			command.type = Render::CommandType::PresentRects;
+			command.first = list.pushRects(dirtyRects.data(), dirtyRects.size());
+			command.count = static_cast<std::uint32_t>(dirtyRects.size());
+			list.push(command);
+		}
 	private:
 		SDL_Renderer* renderer;
 		WindowSystem* window;
 		Color* color;
+		Screen* screen;
+		SDL_Rect viewport;
+		bool hasViewport;
+		std::vector<Render::ProxyID> visibleList;
+		std::vector<Render::CameraView> cameras;
+		Render::DirtyRegionTracker dirtyTracker;
+		std::vector<Render::RenderCommand> sceneCommands;
+		std::vector<SDL_Rect> dirtyRects;
+		bool dirtyRectMode;
+		std::array<Render::RenderCommandList, 2> commandLists;
+		std::size_t writeIndex;
+		bool recording;
+		std::uint64_t listFrame;
+		Render::RenderThread renderThread;
 	};
 
 	template<typename KeyType, typename ValueType>
@@ -149,26 +464,35 @@ namespace ECS
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
-		//!@brief [key]ɑΉ[value]̎擾
+		//!@brief [key]に対応した[value]の取得
 		[[nodiscard]] const ValueType& getTexture(const KeyType& key) const noexcept
 		{
 			return asset.at(key);
 		}
-		//!@brief [key][value]o^
+		//!@brief [key]と[value]を登録
 		[[noreturn]] void regist(const KeyType& key, const ValueType& value) noexcept
 		{
 			asset[key] = value;
+			if constexpr (std::is_convertible_v<KeyType, std::string>)
+			{
+				Event::EventBus::get().publish(Event::AssetLoadedEvent::create(key));
+			}
 		}
-		//!@brief [key][value]̍폜
-		[[nodiscard]] void remove(const KeyType& key) noexcept
+		//!@brief [key]の[value]の削除
+		//!@note [value]が SDL_Texture* なら texture も破棄します
+		void remove(const KeyType& key) noexcept
 		{
-			auto& itr = asset.find(key);
+			const auto itr = asset.find(key);
 			if (itr != asset.end())
 			{
+				if constexpr (std::is_same_v<ValueType, SDL_Texture*>)
+				{
+					SDL_DestroyTexture(itr->second);
+				}
 				asset.erase(itr);
 			}
 		}
-		//!@brief mapŜ̎擾
+		//!@brief map全体の取得
 		[[nodiscard]] const std::unordered_map<KeyType, ValueType>& get() const noexcept
 		{
 			return asset;
@@ -177,7 +501,463 @@ namespace ECS
 		std::unordered_map<KeyType, ValueType> asset;
 	};
 
-	//ftHg texture
-	using AssetTexture = Asset<std::string, SDL_Texture*>;
-	//ftHg sound
+	class TextureCache;
+
+	//!@class TextureHandle
+	//!@brief TextureCache の texture への参照
+	//!@note 参照されている間は texture は追い出されません。コピーすると参照が増えます
+	class TextureHandle final
+	{
+	public:
+		TextureHandle() noexcept = default;
+		TextureHandle(const TextureHandle& other) noexcept;
+		TextureHandle& operator=(const TextureHandle& other);
+		~TextureHandle();
+		//!@brief texture を取得します(追い出されていれば読み込み直します)
+		[[nodiscard]] SDL_Texture* get() const;
+		//!@brief 参照を外します
+		void reset();
+		[[nodiscard]] explicit operator bool() const noexcept
+		{
+			return cache != nullptr;
+		}
+	private:
+		friend class TextureCache;
+		TextureHandle(TextureCache* textureCache, const std::uint32_t entryIndex) noexcept;
+		TextureCache* cache = nullptr;
+		std::uint32_t index = 0;
+	};
+
+	//!@class TextureCacheStats
+	//!@brief TextureCache の統計
+	struct TextureCacheStats
+	{
+		std::uint64_t hitCount = 0;		//読み込み済みだった回数
+		std::uint64_t missCount = 0;	//読み込みが必要だった回数
+		std::uint64_t evictCount = 0;	//追い出した回数
+		std::size_t residentBytes = 0;	//読み込み済みの texture のバイト数
+		std::size_t budgetBytes = 0;
+		std::size_t residentNum = 0;
+		std::size_t textureNum = 0;
+	};
+
+	//!@class TextureCache
+	//!@brief 参照数を持つ texture のキャッシュ
+	//!@note ファイルから登録した texture は、参照されておらず予算を超えたときに使われていない順に追い出し、
+	//!@note 次に使われたときに読み込み直します(カラーMODなど texture に設定した状態は戻りません)
+	//!@note texture の作成と破棄は RendererSystem::invoke() を通して、描画と重ならないように行います
+	//!@note texture は SDL_Renderer と一緒に破棄されるので、このComponentの破棄では破棄しません
+	//!@note 並列に更新されるワールドから TextureHandle をコピー・破棄しても良いように、登録と参照数はロックを取って操作します
+	class TextureCache final : public ECS::ComponentSystem
+	{
+	public:
+		using KeyTypeData = std::string;
+		using ValueTypeData = SDL_Texture*;
+		using Loader = std::function<SDL_Texture*(const std::string& filePath)>;
+		//予算なし
+		static constexpr std::size_t Unlimited = SIZE_MAX;
+	public:
+		[[noreturn]] void initialize() noexcept override
+		{
+			renderer = entity->hasComponent<RendererSystem>() ? &entity->getComponent<RendererSystem>() : nullptr;
+			budgetBytes = Unlimited;
+			lruHead = InvalidIndex;
+			lruTail = InvalidIndex;
+		}
+		[[noreturn]] void update() noexcept override {}
+		[[noreturn]] void draw2D() noexcept override {}
+		[[noreturn]] void draw3D() noexcept override {}
+		//!@brief ファイルから texture を作る関数を設定します
+		void setLoader(const Loader& textureLoader)
+		{
+			loader = textureLoader;
+		}
+		//!@brief 読み込み済みの texture の合計の予算を設定し、超えていれば追い出します
+		void setBudget(const std::size_t bytes)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			budgetBytes = bytes;
+			trim();
+		}
+		//!@brief [key]に[value]を登録します
+		//!@note ファイルがないので追い出されません
+		void regist(const KeyTypeData& key, const ValueTypeData& value)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			const std::uint32_t index = getOrAddEntry(key);
+			Entry& entry = entries[index];
+			entry.filePath.clear();
+			++revision;
+			if (entry.texture != value)
+			{
+				unload(index);
+				setTexture(index, value);
+			}
+			Event::EventBus::get().publish(Event::AssetLoadedEvent::create(key));
+		}
+		//!@brief [key]として[filePath]を登録します
+		//!@param preload true:すぐに読み込む  false:最初に使われたときに読み込む
+		void registFile(const KeyTypeData& key, const std::string& filePath, const bool preload = true)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			const std::uint32_t index = getOrAddEntry(key);
+			unload(index);
+			entries[index].filePath = filePath;
+			++revision;
+			if (preload)
+			{
+				load(index);
+			}
+			Event::EventBus::get().publish(Event::AssetLoadedEvent::create(key));
+		}
+		//!@brief [key]への参照を取得します(登録されていなければ空)
+		[[nodiscard]] TextureHandle acquire(const KeyTypeData& key)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			const auto itr = indices.find(key);
+			if (itr == indices.end())
+			{
+				return TextureHandle();
+			}
+			return TextureHandle(this, itr->second);
+		}
+		//!@brief [key]の texture を取得します(追い出されていれば読み込み直します)
+		//!@note 参照は増えないので、使い続けるなら acquire() を使ってください
+		[[nodiscard]] ValueTypeData getTexture(const KeyTypeData& key)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			const auto itr = indices.find(key);
+			if (itr == indices.end())
+			{
+				return nullptr;
+			}
+			return use(itr->second);
+		}
+		//!@brief [key]の texture を破棄して登録を消します
+		//!@return false:参照されているので消せない
+		bool remove(const KeyTypeData& key)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			const auto itr = indices.find(key);
+			if (itr == indices.end())
+			{
+				return true;
+			}
+			if (entries[itr->second].refCount != 0)
+			{
+				return false;
+			}
+			unload(itr->second);
+			entries[itr->second].filePath.clear();
+			++revision;
+			freeIndices.emplace_back(itr->second);
+			indices.erase(itr);
+			return true;
+		}
+		//!@brief 予算を超えていれば、参照されていない texture を使われていない順に追い出します
+		void trim()
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			trimExcept(InvalidIndex);
+		}
+		//!@brief [filePath]から登録した texture を[texture]に差し替えます(参照はそのまま使えます)
+		//!@note 読み込まれていなければ次に使われたときにファイルから読み込むので、[texture]は破棄します
+		//!@return true:差し替えた
+		bool swapFile(const std::string& filePath, SDL_Texture* texture)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			for (const auto& index : indices)
+			{
+				Entry& entry = entries[index.second];
+				if (entry.filePath == filePath && entry.texture != nullptr)
+				{
+					unload(index.second);
+					setTexture(index.second, texture);
+					trimExcept(index.second);
+					return true;
+				}
+			}
+			runOnRenderer([texture]() { SDL_DestroyTexture(texture); });
+			return false;
+		}
+		//!@brief ファイルから登録した texture のパスを[filePaths]に入れます
+		void getFiles(std::vector<std::string>& filePaths) const
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			filePaths.clear();
+			for (const auto& index : indices)
+			{
+				if (!entries[index.second].filePath.empty())
+				{
+					filePaths.emplace_back(entries[index.second].filePath);
+				}
+			}
+		}
+		//!@brief 登録が変わるたびに増える値
+		[[nodiscard]] std::uint32_t getRevision() const noexcept
+		{
+			return revision;
+		}
+		//!@brief 統計を取得します
+		[[nodiscard]] TextureCacheStats getStats() const
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			TextureCacheStats result = stats;
+			result.residentBytes = residentBytes;
+			result.budgetBytes = budgetBytes;
+			result.textureNum = indices.size();
+			result.residentNum = 0;
+			for (const auto& index : indices)
+			{
+				if (entries[index.second].texture != nullptr)
+				{
+					++result.residentNum;
+				}
+			}
+			return result;
+		}
+	private:
+		friend class TextureHandle;
+		static constexpr std::uint32_t InvalidIndex = UINT32_MAX;
+		struct Entry
+		{
+			std::string filePath;
+			SDL_Texture* texture = nullptr;
+			std::size_t bytes = 0;
+			std::uint32_t refCount = 0;
+			//読み込み済みで参照されていない、ファイルから登録した texture の使われた順のリスト
+			std::uint32_t lruPrev = InvalidIndex;
+			std::uint32_t lruNext = InvalidIndex;
+			bool inLru = false;
+		};
+		std::uint32_t getOrAddEntry(const KeyTypeData& key)
+		{
+			const auto itr = indices.find(key);
+			if (itr != indices.end())
+			{
+				return itr->second;
+			}
+			std::uint32_t index;
+			if (!freeIndices.empty())
+			{
+				index = freeIndices.back();
+				freeIndices.pop_back();
+				entries[index] = Entry();
+			}
+			else
+			{
+				index = static_cast<std::uint32_t>(entries.size());
+				entries.emplace_back();
+			}
+			indices[key] = index;
+			return index;
+		}
+		//!@brief 読み込み済みにして、参照されていなければ最近使ったことにします
+		SDL_Texture* use(const std::uint32_t index)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			Entry& entry = entries[index];
+			if (entry.texture != nullptr)
+			{
+				++stats.hitCount;
+			}
+			else
+			{
+				++stats.missCount;
+				load(index);
+			}
+			if (entry.inLru && lruTail != index)
+			{
+				unlinkLru(index);
+				linkLru(index);
+			}
+			return entry.texture;
+		}
+		void load(const std::uint32_t index)
+		{
+			Entry& entry = entries[index];
+			if (entry.texture != nullptr || entry.filePath.empty() || !loader)
+			{
+				return;
+			}
+			SDL_Texture* texture = nullptr;
+			runOnRenderer([this, &entry, &texture]() { texture = loader(entry.filePath); });
+			setTexture(index, texture);
+			//予算は読み込んだ後に見るが、読み込んだものは追い出さない
+			trimExcept(index);
+		}
+		void trimExcept(const std::uint32_t keep)
+		{
+			while (residentBytes > budgetBytes && lruHead != InvalidIndex && lruHead != keep)
+			{
+				unload(lruHead);
+				++stats.evictCount;
+			}
+		}
+		void unload(const std::uint32_t index)
+		{
+			Entry& entry = entries[index];
+			if (entry.texture == nullptr)
+			{
+				return;
+			}
+			if (entry.inLru)
+			{
+				unlinkLru(index);
+			}
+			SDL_Texture* texture = entry.texture;
+			runOnRenderer([texture]() { SDL_DestroyTexture(texture); });
+			residentBytes -= entry.bytes;
+			entry.texture = nullptr;
+			entry.bytes = 0;
+		}
+		void setTexture(const std::uint32_t index, SDL_Texture* texture)
+		{
+			Entry& entry = entries[index];
+			entry.texture = texture;
+			entry.bytes = 0;
+			if (texture != nullptr)
+			{
+				Uint32 format = 0;
+				int w = 0;
+				int h = 0;
+				SDL_QueryTexture(texture, &format, nullptr, &w, &h);
+				entry.bytes = static_cast<std::size_t>(w) * static_cast<std::size_t>(h) * static_cast<std::size_t>(SDL_BYTESPERPIXEL(format));
+			}
+			residentBytes += entry.bytes;
+			if (texture != nullptr && entry.refCount == 0 && !entry.filePath.empty())
+			{
+				linkLru(index);
+			}
+		}
+		//!@brief [task]を描画と重ならないように実行します
+		void runOnRenderer(const std::function<void()>& task)
+		{
+			if (renderer != nullptr)
+			{
+				renderer->invoke(task);
+				return;
+			}
+			task();
+		}
+		void linkLru(const std::uint32_t index)
+		{
+			Entry& entry = entries[index];
+			entry.lruPrev = lruTail;
+			entry.lruNext = InvalidIndex;
+			entry.inLru = true;
+			if (lruTail != InvalidIndex)
+			{
+				entries[lruTail].lruNext = index;
+			}
+			else
+			{
+				lruHead = index;
+			}
+			lruTail = index;
+		}
+		void unlinkLru(const std::uint32_t index)
+		{
+			Entry& entry = entries[index];
+			if (entry.lruPrev != InvalidIndex)
+			{
+				entries[entry.lruPrev].lruNext = entry.lruNext;
+			}
+			else
+			{
+				lruHead = entry.lruNext;
+			}
+			if (entry.lruNext != InvalidIndex)
+			{
+				entries[entry.lruNext].lruPrev = entry.lruPrev;
+			}
+			else
+			{
+				lruTail = entry.lruPrev;
+			}
+			entry.lruPrev = InvalidIndex;
+			entry.lruNext = InvalidIndex;
+			entry.inLru = false;
+		}
+		void addRef(const std::uint32_t index) noexcept
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			Entry& entry = entries[index];
+			if (entry.refCount++ == 0 && entry.inLru)
+			{
+				unlinkLru(index);
+			}
+		}
+		void release(const std::uint32_t index)
+		{
+			std::lock_guard<std::recursive_mutex> guard(mutex);
+			Entry& entry = entries[index];
+			if (--entry.refCount == 0 && entry.texture != nullptr && !entry.filePath.empty())
+			{
+				linkLru(index);
+				trim();
+			}
+		}
+	private:
+		RendererSystem* renderer;
+		Loader loader;
+		std::unordered_map<KeyTypeData, std::uint32_t> indices;
+		std::vector<Entry> entries;
+		std::vector<std::uint32_t> freeIndices;
+		std::uint32_t lruHead;
+		std::uint32_t lruTail;
+		std::size_t residentBytes = 0;
+		std::size_t budgetBytes;
+		std::uint32_t revision = 0;
+		TextureCacheStats stats;
+		//release() から trim() を呼ぶなど入れ子になるので再帰ロック
+		mutable std::recursive_mutex mutex;
+	};
+
+	inline TextureHandle::TextureHandle(TextureCache* textureCache, const std::uint32_t entryIndex) noexcept
+		: cache(textureCache), index(entryIndex)
+	{
+		cache->addRef(index);
+	}
+	inline TextureHandle::TextureHandle(const TextureHandle& other) noexcept
+		: cache(other.cache), index(other.index)
+	{
+		if (cache != nullptr)
+		{
+			cache->addRef(index);
+		}
+	}
+	inline TextureHandle& TextureHandle::operator=(const TextureHandle& other)
+	{
+		if (other.cache != nullptr)
+		{
+			other.cache->addRef(other.index);
+		}
+		reset();
+		cache = other.cache;
+		index = other.index;
+		return *this;
+	}
+	inline TextureHandle::~TextureHandle()
+	{
+		reset();
+	}
+	inline SDL_Texture* TextureHandle::get() const
+	{
+		return cache == nullptr ? nullptr : cache->use(index);
+	}
+	inline void TextureHandle::reset()
+	{
+		if (cache != nullptr)
+		{
+			cache->release(index);
+			cache = nullptr;
+		}
+	}
+
+	//デフォルト texture
+	using AssetTexture = TextureCache;
+	//デフォルト font
+	using AssetFont = Asset<std::string, std::shared_ptr<Render::BitmapFont>>;
+	//デフォルト sound
 }
\ No newline at end of file
@@ -0,0 +1,353 @@
+//---------------------------------------------------------
+//!@file ParticleEmitter.hpp
+//!@brief パーティクルの Component を用意します
+//!@author Volka
+//!@date 2018/11/3
+//!@note パーティクルは Entity にせず、要素ごとの配列(SoA)で持ちます
+//!@note 更新は SSE2 で4個ずつ行い、寿命が尽きたものは末尾と入れ替えて消します
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOLKA_PARTICLE_SSE2
+#endif
+#include "../ECS/ECS.hpp"
+#include "../ComponentSystem/EngineComponents.hpp"
+#include "../Render/DrawScene.hpp"
+
+namespace ECS
+{
+	//!@class ParticlePool
+	//!@brief 容量が固定のパーティクルの配列
+	class ParticlePool final
+	{
+	public:
+		explicit ParticlePool(const std::size_t capacity)
+		{
+			//4個ずつ処理するので4の倍数にしておく
+			const std::size_t size = (capacity + 3) & ~static_cast<std::size_t>(3);
+			posX.resize(size);
+			posY.resize(size);
+			velX.resize(size);
+			velY.resize(size);
+			life.resize(size);
+			invMaxLife.resize(size);
+			color.resize(size);
+			capacityNum = capacity;
+			count = 0;
+		}
+		//!@brief [num]個を追加し、追加した先頭の番号を返します(容量を超えた分は追加しません)
+		std::size_t emit(std::size_t& num) noexcept
+		{
+			num = std::min(num, capacityNum - count);
+			const std::size_t first = count;
+			count += num;
+			return first;
+		}
+		//!@brief [dt]秒進め、寿命が尽きたものを消します
+		//!@param gravityX, gravityY 加速度
+		void update(const float dt, const float gravityX, const float gravityY) noexcept
+		{
+			float minX = std::numeric_limits<float>::max(), minY = minX;
+			float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+			std::size_t i = 0;
+#ifdef VOLKA_PARTICLE_SSE2
+			const __m128 step = _mm_set1_ps(dt);
+			const __m128 accelX = _mm_set1_ps(gravityX * dt);
+			const __m128 accelY = _mm_set1_ps(gravityY * dt);
+			__m128 minX4 = _mm_set1_ps(minX), minY4 = minX4;
+			__m128 maxX4 = _mm_set1_ps(maxX), maxY4 = maxX4;
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 vx = _mm_add_ps(_mm_loadu_ps(&velX[i]), accelX);
+				const __m128 vy = _mm_add_ps(_mm_loadu_ps(&velY[i]), accelY);
+				const __m128 px = _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_mul_ps(vx, step));
+				const __m128 py = _mm_add_ps(_mm_loadu_ps(&posY[i]), _mm_mul_ps(vy, step));
+				_mm_storeu_ps(&velX[i], vx);
+				_mm_storeu_ps(&velY[i], vy);
+				_mm_storeu_ps(&posX[i], px);
+				_mm_storeu_ps(&posY[i], py);
+				_mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]), step));
+				minX4 = _mm_min_ps(minX4, px);
+				minY4 = _mm_min_ps(minY4, py);
+				maxX4 = _mm_max_ps(maxX4, px);
+				maxY4 = _mm_max_ps(maxY4, py);
+			}
+			alignas(16) float lane[4];
+			_mm_store_ps(lane, minX4); minX = std::min({ lane[0], lane[1], lane[2], lane[3] });
+			_mm_store_ps(lane, minY4); minY = std::min({ lane[0], lane[1], lane[2], lane[3] });
+			_mm_store_ps(lane, maxX4); maxX = std::max({ lane[0], lane[1], lane[2], lane[3] });
+			_mm_store_ps(lane, maxY4); maxY = std::max({ lane[0], lane[1], lane[2], lane[3] });
+#endif
+			for (; i < count; ++i)
+			{
+				velX[i] += gravityX * dt;
+				velY[i] += gravityY * dt;
+				posX[i] += velX[i] * dt;
+				posY[i] += velY[i] * dt;
+				life[i] -= dt;
+				minX = std::min(minX, posX[i]);
+				minY = std::min(minY, posY[i]);
+				maxX = std::max(maxX, posX[i]);
+				maxY = std::max(maxY, posY[i]);
+			}
+			boundsMin = { minX, minY };
+			boundsMax = { maxX, maxY };
+			removeDead();
+		}
+		//!@brief すべて消します
+		void clear() noexcept
+		{
+			count = 0;
+		}
+		[[nodiscard]] std::size_t size() const noexcept { return count; }
+		[[nodiscard]] std::size_t capacity() const noexcept { return capacityNum; }
+		//!@brief 直前の update() での位置の範囲(消えたものも含む)
+		[[nodiscard]] SDL_FPoint getBoundsMin() const noexcept { return boundsMin; }
+		[[nodiscard]] SDL_FPoint getBoundsMax() const noexcept { return boundsMax; }
+	private:
+		//!@brief 寿命が尽きたものを末尾と入れ替えて消します(順番は保たない)
+		void removeDead() noexcept
+		{
+			std::size_t i = 0;
+			while (i < count)
+			{
+				if (life[i] > 0.0f)
+				{
+					++i;
+					continue;
+				}
+				--count;
+				posX[i] = posX[count];
+				posY[i] = posY[count];
+				velX[i] = velX[count];
+				velY[i] = velY[count];
+				life[i] = life[count];
+				invMaxLife[i] = invMaxLife[count];
+				color[i] = color[count];
+			}
+		}
+	public:
+		std::vector<float> posX;
+		std::vector<float> posY;
+		std::vector<float> velX;
+		std::vector<float> velY;
+		std::vector<float> life;		//残りの寿命(秒)
+		std::vector<float> invMaxLife;	//1 / 最初の寿命
+		std::vector<SDL_Color> color;
+	private:
+		std::size_t capacityNum;
+		std::size_t count;
+		SDL_FPoint boundsMin = { 0.0f, 0.0f };
+		SDL_FPoint boundsMax = { 0.0f, 0.0f };
+	};
+
+	//!@class ParticleEmitter
+	//!@brief パーティクルを放出し、まとめて1回のジオメトリで描画します
+	//!@note Position があればその位置から、なければ setOrigin() の位置から放出します
+	class ParticleEmitter final : public ComponentSystem, public Render::GeometrySource
+	{
+	public:
+		//!@brief texture なし(色の四角形)で[capacity]個まで出せるエミッタを作ります
+		explicit ParticleEmitter(const std::size_t capacity) noexcept
+			: pool(capacity), useTexture(false)
+		{
+			setDefault();
+		}
+		//!@brief [key]の texture を貼ったパーティクルを[capacity]個まで出せるエミッタを作ります
+		explicit ParticleEmitter(const std::size_t capacity, const AssetTexture::KeyTypeData& key) noexcept
+			: pool(capacity), accessKey(key), useTexture(true)
+		{
+			setDefault();
+		}
+		void initialize() noexcept override
+		{
+			if (useTexture)
+			{
+				auto& engine = EntitySystemManager::get().getEntityManager("engine").getEntitiesByGroup(ENTITY_GROUP::Engine).at(0);
+				texture = engine->getComponent<AssetTexture>().acquire(accessKey);
+			}
+			position = entity->hasComponent<Position>() ? &entity->getComponent<Position>() : nullptr;
+			proxy.create();
+		}
+		void update() noexcept override
+		{
+			emitAccumulator += rate * timeStep;
+			if (emitAccumulator >= 1.0f)
+			{
+				const std::size_t num = static_cast<std::size_t>(emitAccumulator);
+				emitAccumulator -= static_cast<float>(num);
+				burst(num);
+			}
+			if (pool.size() == 0)
+			{
+				return;
+			}
+			pool.update(timeStep, gravity.xValue, gravity.yValue);
+			++revision;
+		}
+		void draw2D() noexcept override
+		{
+			if (pool.size() == 0)
+			{
+				return;
+			}
+			//update() の後に burst() されたものは放出位置にいる
+			const float originX = position != nullptr ? position->position.xValue : origin.xValue;
+			const float originY = position != nullptr ? position->position.yValue : origin.yValue;
+			const SDL_FPoint minPos = { std::min(pool.getBoundsMin().x, originX), std::min(pool.getBoundsMin().y, originY) };
+			const SDL_FPoint maxPos = { std::max(pool.getBoundsMax().x, originX), std::max(pool.getBoundsMax().y, originY) };
+			const float half = size * 0.5f;
+			Render::RenderCommand command;
+			command.type = Render::CommandType::Geometry;
+			command.texture = texture.get();
+			command.geometry = this;
+			command.revision = revision;
+			command.useBlend = command.texture != nullptr;
+			command.blendMode = blendMode;
+			command.dst.x = static_cast<int>(std::floor(minPos.x - half));
+			command.dst.y = static_cast<int>(std::floor(minPos.y - half));
+			command.dst.w = static_cast<int>(std::ceil(maxPos.x + half)) - command.dst.x;
+			command.dst.h = static_cast<int>(std::ceil(maxPos.y + half)) - command.dst.y;
+			Render::DrawScene::get().update(proxy, command, command.dst);
+		}
+		void draw3D() noexcept override {}
+		//!@brief 生きているパーティクル1個につき2枚の三角形
+		std::size_t getVertexCount(const std::uint32_t /*part*/) override
+		{
+			return pool.size() * 6;
+		}
+		//!@brief 残りの寿命に合わせて Alpha値を下げた四角形を書き込みます
+		void writeVertices(const std::uint32_t /*part*/, SDL_Vertex* out) override
+		{
+			const float half = size * 0.5f;
+			const std::size_t num = pool.size();
+			for (std::size_t i = 0; i < num; ++i)
+			{
+				const float x = pool.posX[i];
+				const float y = pool.posY[i];
+				SDL_Color c = pool.color[i];
+				c.a = static_cast<Uint8>(c.a * std::min(pool.life[i] * pool.invMaxLife[i], 1.0f));
+				SDL_Vertex* v = out + i * 6;
+				v[0] = { { x - half, y - half }, c, { 0.0f, 0.0f } };
+				v[1] = { { x + half, y - half }, c, { 1.0f, 0.0f } };
+				v[2] = { { x - half, y + half }, c, { 0.0f, 1.0f } };
+				v[3] = v[1];
+				v[4] = { { x + half, y + half }, c, { 1.0f, 1.0f } };
+				v[5] = v[2];
+			}
+		}
+		//!@brief [num]個を今すぐ放出します
+		void burst(std::size_t num) noexcept
+		{
+			const float originX = position != nullptr ? position->position.xValue : origin.xValue;
+			const float originY = position != nullptr ? position->position.yValue : origin.yValue;
+			const std::size_t first = pool.emit(num);
+			for (std::size_t i = first; i < first + num; ++i)
+			{
+				const float angle = (direction + random(-spread, spread) * 0.5f) * Pi / 180.0f;
+				const float speed = random(speedMin, speedMax);
+				const float lifeTime = random(lifeMin, lifeMax);
+				pool.posX[i] = originX;
+				pool.posY[i] = originY;
+				pool.velX[i] = std::cos(angle) * speed;
+				pool.velY[i] = std::sin(angle) * speed;
+				pool.life[i] = lifeTime;
+				pool.invMaxLife[i] = 1.0f / lifeTime;
+				pool.color[i] = color;
+			}
+		}
+		//!@brief 1秒あたりに放出する数を設定します
+		void setRate(const float perSecond) noexcept { rate = perSecond; }
+		//!@brief 放出する向き(度、0が右)と広がり(度)を設定します
+		void setDirection(const float degree, const float spreadDegree) noexcept
+		{
+			direction = degree;
+			spread = spreadDegree;
+		}
+		//!@brief 速さの範囲(ピクセル/秒)を設定します
+		void setSpeed(const float minSpeed, const float maxSpeed) noexcept
+		{
+			speedMin = minSpeed;
+			speedMax = maxSpeed;
+		}
+		//!@brief 寿命の範囲(秒)を設定します
+		void setLifeTime(const float minLife, const float maxLife) noexcept
+		{
+			lifeMin = std::max(minLife, 0.001f);
+			lifeMax = std::max(maxLife, lifeMin);
+		}
+		//!@brief 加速度(ピクセル/秒^2)を設定します
+		void setGravity(const Vector2& acceleration) noexcept { gravity = acceleration; }
+		//!@brief パーティクルの大きさ(ピクセル)を設定します
+		void setSize(const float pixel) noexcept { size = pixel; }
+		//!@brief 放出するときの色を設定します
+		void setColor(const SDL_Color& startColor) noexcept { color = startColor; }
+		//!@brief texture のブレンドモードを設定します
+		void setBlendMode(const SDL_BlendMode mode) noexcept { blendMode = mode; }
+		//!@brief Position がないときの放出位置を設定します
+		void setOrigin(const Vector2& point) noexcept { origin = point; }
+		//!@brief 1フレームの秒数を設定します(既定は Runtime::getTimeStep())
+		void setTimeStep(const float seconds) noexcept { timeStep = seconds; }
+		//!@brief 生きているパーティクルの数
+		[[nodiscard]] std::size_t getCount() const noexcept { return pool.size(); }
+	private:
+		void setDefault() noexcept
+		{
+			rate = 0.0f;
+			emitAccumulator = 0.0f;
+			direction = -90.0f;
+			spread = 360.0f;
+			speedMin = 50.0f;
+			speedMax = 150.0f;
+			lifeMin = 0.5f;
+			lifeMax = 1.5f;
+			gravity = Vector2(0.0f, 0.0f);
+			size = 4.0f;
+			color = { 0xFF, 0xFF, 0xFF, 0xFF };
+			blendMode = SDL_BLENDMODE_BLEND;
+			origin = Vector2(0.0f, 0.0f);
+			timeStep = static_cast<float>(Runtime::get().getTimeStep());
+			revision = 0;
+			randomState = 0x9E3779B9u;
+		}
+		//!@brief [min, max) の乱数(xorshift)
+		float random(const float min, const float max) noexcept
+		{
+			randomState ^= randomState << 13;
+			randomState ^= randomState >> 17;
+			randomState ^= randomState << 5;
+			return min + (max - min) * static_cast<float>(randomState >> 8) * (1.0f / 16777216.0f);
+		}
+	private:
+		static constexpr float Pi = 3.14159265358979f;
+		ParticlePool pool;
+		AssetTexture::KeyTypeData accessKey;
+		bool useTexture;
+		TextureHandle texture;
+		Position* position;
+		Render::ProxyHandle proxy;
+		float rate;
+		float emitAccumulator;
+		float direction;
+		float spread;
+		float speedMin;
+		float speedMax;
+		float lifeMin;
+		float lifeMax;
+		Vector2 gravity;
+		float size;
+		SDL_Color color;
+		SDL_BlendMode blendMode;
+		Vector2 origin;
+		float timeStep;
+		std::uint32_t revision;
+		std::uint32_t randomState;
+	};
+}
\ No newline at end of file
@@ -1,18 +1,21 @@
 //---------------------------------------------------------
 //!@file Renderer.hpp
-//!@brief WIRendererComponentQpӂ܂
+//!@brief 標準的なRendererのComponent群を用意します
 //!@author Volka
 //!@date 2018/11/3
-//!@note 
+//!@note 各Componentは SDL を直接呼ばずに、描画プロキシを更新します
+//!@note 見えているプロキシだけが RendererSystem のコマンドリストに積まれます
 //---------------------------------------------------------
 #pragma once
 #include "../ECS/ECS.hpp"
 #include "../ComponentSystem/EngineComponents.hpp"
+#include "../Render/DrawScene.hpp"
 
 namespace ECS
 {
 	//!@class Renderer
-	//!@brief `s悤ɂ܂
+	//!@brief 描画を行えるようにします
+	//!@brief フレームの最初にリストを用意し、最後に描画スレッドへ渡します
 	class Renderer final : public ComponentSystem
 	{
 	public:
@@ -20,34 +23,32 @@ namespace ECS
 		{
 			auto& e = ECS::EntitySystemManager::get().getEntityManager("engine").getEntitiesByGroup(ENTITY_GROUP::Engine).at(0);
 			renderer = &e->getComponent<RendererSystem>();
-			color = &e->getComponent<Color>();
 		}
 		void update() noexcept override
 		{
-			SDL_SetRenderDrawColor(&renderer->GetRenderer(), color->value.xValue, color->value.yValue, color->value.zValue, color->value.wValue);
-			SDL_RenderClear(&renderer->GetRenderer());
+			//Clear はリストの先頭に積まれる
+			(void)renderer->getCommandList();
 		}
 		void draw2D() noexcept override
 		{
-			SDL_RenderPresent(&renderer->GetRenderer());
+			renderer->present();
 		}
 		void draw3D()noexcept override {}
 	private:
 		ECS::RendererSystem* renderer;
-		ECS::Color* color;
 	};
 
 	//!@class GeometryRenderer
-	//!@brief WIg`悵܂
+	//!@brief ジオメトリを描画します
 	class GeometryRenderer final : public ComponentSystem
 	{
 	public:
 		enum class Mode
 		{
-			Fill,		//hԂ
-			Wireframe,	//C[t[
-			Line,		//
-			Point,		//_
+			Fill,		//塗りつぶし
+			Wireframe,	//ワイヤーフレーム
+			Line,		//線
+			Point,		//点
 		};
 	public:
 		explicit GeometryRenderer() noexcept
@@ -72,38 +73,69 @@ namespace ECS
 			{
 				entity->addComponent<Color>().setColor(Vector4Type<Uint8>(0xFF, 0xFF, 0xFF, 0xFF));
 			}
-			color = &entity->getComponent<Color>();
+			proxy.create();
+			built = false;
+			//Color の追加・削除は通知で受け取り、プールの値へのポインタを取り直す
+			observeSiblings();
+			rebind(color, getComponentTypeID<Color>());
+		}
+		void onComponentAdded(const ComponentID id) override
+		{
+			rebind(color, id);
+		}
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(color, id);
 		}
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
-		[[noreturn]] void draw2D() noexcept override
+		void draw2D() noexcept override
 		{
-			SDL_SetRenderDrawColor(&renderer->GetRenderer(), color->value.xValue, color->value.yValue, color->value.zValue, color->value.wValue);
+			//色が変わっていなければ前のフレームのコマンドをそのまま使う
+			//Color はデータComponentで直接書き換えられるので、変更の時刻ではなく値で比べる
+			//Color が外されたら、initialize() で付けるときと同じ白で描く
+			const SDL_Color nowColor = color != nullptr ?
+				SDL_Color{ color->value.xValue, color->value.yValue, color->value.zValue, color->value.wValue } :
+				SDL_Color{ 0xFF, 0xFF, 0xFF, 0xFF };
+			if (built && nowColor.r == builtColor.r && nowColor.g == builtColor.g && nowColor.b == builtColor.b && nowColor.a == builtColor.a)
+			{
+				Render::DrawScene::get().keep(proxy);
+				return;
+			}
+			built = true;
+			builtColor = nowColor;
+			Render::RenderCommand command;
+			command.color = nowColor;
+			command.dst = rect;
 			switch (mode)
 			{
-			case Mode::Fill: SDL_RenderFillRect(&renderer->GetRenderer(), &rect); break;
-			case Mode::Wireframe: SDL_RenderDrawRect(&renderer->GetRenderer(), &rect); break;
-			case Mode::Line: SDL_RenderDrawLine(&renderer->GetRenderer(), rect.x, rect.y, rect.w, rect.h); break;
-			case Mode::Point: SDL_RenderDrawPoint(&renderer->GetRenderer(), rect.x, rect.y); break;
+			case Mode::Fill: command.type = Render::CommandType::FillRect; break;
+			case Mode::Wireframe: command.type = Render::CommandType::DrawRect; break;
+			case Mode::Line: command.type = Render::CommandType::DrawLine; break;
+			case Mode::Point: command.type = Render::CommandType::DrawPoint; break;
 			}
+			Render::DrawScene::get().update(proxy, command, Render::GetCommandBounds(command));
 		}
 	private:
 		SDL_Rect rect;
 		Mode mode;
+		Render::ProxyHandle proxy;
 		RendererSystem* renderer;
-		Color* color;
+		Color* color = nullptr;
+		SDL_Color builtColor;
+		bool built;
 	};
 
 	//!@class RotationTexture
-	//!@brief texture]܂
+	//!@brief textureを回転させます
 	class RotationTexture final : public ComponentData
 	{
 	public:
 		enum class FlipMode
 		{
-			None,		//tbvȂ
-			Horizontal, //Ƀtbv
-			Vertical,	//Ƀtbv
+			None,		//フリップしない
+			Horizontal, //水平にフリップ
+			Vertical,	//垂直にフリップ
 		};
 	public:
 		explicit RotationTexture() noexcept
@@ -119,27 +151,27 @@ namespace ECS
 			flipMode = flip;
 		}
 	public:
-		//!@brief px̎擾
+		//!@brief 角度の取得
 		[[nodiscard]] const float getAngle() const noexcept
 		{
 			return angle;
 		}
-		//!@brief s{bg(]̒S_)̎擾
+		//!@brief ピボット(回転の中心点)の取得
 		[[nodiscard]] const Vector2& getPivot() const noexcept
 		{
 			return pivot;
 		}
-		//!@brief tbv[h̎擾
+		//!@brief フリップモードの取得
 		[[nodiscard]] const FlipMode& getFlipMode() const noexcept
 		{
 			return flipMode;
 		}
-		//!@brief px̐ݒ
+		//!@brief 角度の設定
 		[[noreturn]] void setAngle(const float rotateAngle) noexcept
 		{
 			angle = rotateAngle;
 		}
-		//!@brief s{bg(]̒S_)̐ݒ
+		//!@brief ピボット(回転の中心点)の設定
 		[[noreturn]] void setPivot(const Vector2& pivotPoint) noexcept
 		{
 			pivot = pivotPoint;
@@ -155,7 +187,8 @@ namespace ECS
 	};
 
 	//!@class DrawTexture
-	//!@brief texture`悵܂
+	//!@brief textureを描画します
+	//!@note ブレンドモードは BlendChangedEvent で受け取ります(1つの関数がフレームに1回ハンドルで宛先を引いて配ります)
 	class DrawTexture final : public ComponentSystem
 	{
 	public:
@@ -167,72 +200,105 @@ namespace ECS
 		{
 			auto& engine = EntitySystemManager::get().getEntityManager("engine").getEntitiesByGroup(ENTITY_GROUP::Engine).at(0);
 			renderer = &engine->getComponent<RendererSystem>();
-			texList = &engine->getComponent<AssetTexture>();
-			rotation = nullptr;
+			texture = engine->getComponent<AssetTexture>().acquire(accessKey);
+			useBlend = false;
+			blendMode = SDL_BLENDMODE_NONE;
+			alpha = 0xFF;
+			proxy.create();
+			//RotationTexture の追加・削除は通知で受け取り、毎フレーム hasComponent() で調べない
+			observeSiblings();
+			rebind(rotation, getComponentTypeID<RotationTexture>());
+			static const bool subscribed = (Event::EventBus::get().subscribe<Event::BlendChangedEvent>(onBlendChanged), true);
+			(void)subscribed;
+		}
+		void onComponentAdded(const ComponentID id) override
+		{
+			rebind(rotation, id);
+		}
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(rotation, id);
 		}
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override
 		{
-			SDL_Rect drawRect = Convert(drawRectData);
-			SDL_Rect srcRect = Convert(srcRectData);
-			if (entity->hasComponent<RotationTexture>())
+			Render::RenderCommand command;
+			command.type = Render::CommandType::Copy;
+			command.texture = texture.get();
+			command.dst = Convert(drawRectData);
+			command.src = Convert(srcRectData);
+			command.useBlend = useBlend;
+			command.blendMode = blendMode;
+			command.color.a = alpha;
+			if (rotation != nullptr)
 			{
-				if (rotation == nullptr)
-				{
-					rotation = &entity->getComponent<RotationTexture>();
-				}
-				double angle = static_cast<double>(rotation->getAngle());
-				SDL_Point pivot = { 0,0 };
-				pivot.x = static_cast<int>(rotation->getPivot().xValue);
-				pivot.y = static_cast<int>(rotation->getPivot().yValue);
-				SDL_RendererFlip flip = SDL_FLIP_NONE;
+				command.useRotation = true;
+				command.angle = static_cast<double>(rotation->getAngle());
+				command.pivot.x = static_cast<int>(rotation->getPivot().xValue);
+				command.pivot.y = static_cast<int>(rotation->getPivot().yValue);
 				switch (rotation->getFlipMode())
 				{
-				case RotationTexture::FlipMode::None: flip = SDL_FLIP_NONE; break;
-				case RotationTexture::FlipMode::Horizontal: flip = SDL_FLIP_HORIZONTAL; break;
-				case RotationTexture::FlipMode::Vertical: flip = SDL_FLIP_VERTICAL; break;
+				case RotationTexture::FlipMode::None: command.flip = SDL_FLIP_NONE; break;
+				case RotationTexture::FlipMode::Horizontal: command.flip = SDL_FLIP_HORIZONTAL; break;
+				case RotationTexture::FlipMode::Vertical: command.flip = SDL_FLIP_VERTICAL; break;
 				}
-				SDL_RenderCopyEx(&renderer->GetRenderer(), texList->getTexture(accessKey), &srcRect, &drawRect,angle,&pivot,flip);
-			}
-			else
-			{
-				SDL_RenderCopy(&renderer->GetRenderer(), texList->getTexture(accessKey), &srcRect, &drawRect);
 			}
+			Render::DrawScene::get().update(proxy, command, Render::GetCommandBounds(command));
 		}
 		[[noreturn]] void draw3D() noexcept override {}
-		//!@brief drawRect̐ݒ
+		//!@brief drawRectの設定
 		[[noreturn]] void setDrawRect(const Vector4& rect) noexcept
 		{
 			drawRectData = rect;
 		}
-		//!@brief srcRect̐ݒ
+		//!@brief srcRectの設定
 		[[noreturn]] void setSrcRect(const Vector4& rect) noexcept
 		{
 			srcRectData = rect;
 		}
-		//!@brief [drawRect][srcRect]ݒ
+		//!@brief [drawRect]と[srcRect]を設定
 		[[noreturn]] void setRect(const Vector4& drawRect, const Vector4& srcRect) noexcept
 		{
 			setDrawRect(drawRect);
 			setSrcRect(srcRect);
 		}
-		//!@brief ANZX[key][value]擾܂
-		[[nodiscard]] const AssetTexture::ValueTypeData& getValue() const noexcept
+		//!@brief 描画時のブレンドモードと[alpha]値を設定します
+		[[noreturn]] void setBlend(const SDL_BlendMode mode, const Uint8 alphaValue) noexcept
+		{
+			useBlend = true;
+			blendMode = mode;
+			alpha = alphaValue;
+		}
+		//!@brief 前のフレームで画面に映っていたか
+		[[nodiscard]] bool isVisible() const noexcept
 		{
-			return texList->getTexture(accessKey);
+			return Render::DrawScene::get().isVisible(proxy);
 		}
-		//!@brief [drawRect]擾܂
+		//!@brief アクセスした[key]の[value]を取得します
+		[[nodiscard]] AssetTexture::ValueTypeData getValue() const noexcept
+		{
+			return texture.get();
+		}
+		//!@brief [drawRect]を取得します
 		[[nodiscard]] const Vector4& getDrawRect() const noexcept
 		{
 			return drawRectData;
 		}
-		//!@brief [srcRect]擾܂
+		//!@brief [srcRect]を取得します
 		[[nodiscard]] const Vector4& getSrcRect() const noexcept
 		{
 			return srcRectData;
 		}
 	private:
-		//!@brief Ro[g
+		static void onBlendChanged(const Event::BlendChangedEvent& event)
+		{
+			Entity* target = EntityRegistry::get().find(event.entity);
+			if (target != nullptr && target->hasComponent<DrawTexture>())
+			{
+				target->getComponent<DrawTexture>().setBlend(static_cast<SDL_BlendMode>(event.blendMode), event.alpha);
+			}
+		}
+		//!@brief コンバート
 		const SDL_Rect Convert(const Vector4& vector4) const noexcept
 		{
 			SDL_Rect rect;
@@ -244,15 +310,19 @@ namespace ECS
 		}
 	private:
 		RendererSystem* renderer;
-		AssetTexture* texList;
 		AssetTexture::KeyTypeData accessKey;
-		RotationTexture* rotation;
+		TextureHandle texture;
+		RotationTexture* rotation = nullptr;
 		Vector4 drawRectData;
 		Vector4 srcRectData;
+		SDL_BlendMode blendMode;
+		bool useBlend;
+		Uint8 alpha;
+		Render::ProxyHandle proxy;
 	};
 
 	//!@class SpriteSheetRenderer
-	//!@brief XvCg`悵܂
+	//!@brief スプライトを描画します
 	class SpriteSheetRenderer final : public ComponentSystem
 	{
 	public:
@@ -260,11 +330,13 @@ namespace ECS
 		{
 			keyFrameData = 0;
 			clipNumData = 0;
+			skipOffscreen = false;
 		}
 		explicit SpriteSheetRenderer(const int keyFrame, const int clipNum) noexcept
 		{
 			keyFrameData = keyFrame;
 			clipNumData = clipNum;
+			skipOffscreen = false;
 		}
 		[[noreturn]] void initialize() noexcept override
 		{
@@ -272,10 +344,32 @@ namespace ECS
 			nowClip = 0;
 			texture = &entity->getComponent<DrawTexture>();
 			clipData = texture->getSrcRect();
+			observeSiblings();
+		}
+		void onComponentAdded(const ComponentID id) override
+		{
+			rebind(texture, id);
+			if (texture != nullptr)
+			{
+				clipData = texture->getSrcRect();
+			}
 		}
-		[[noreturn]] void update() noexcept override
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(texture, id);
+		}
+		void update() noexcept override
 		{
 			++animFrame;
+			if (texture == nullptr)
+			{
+				return;
+			}
+			//画面外なら切り取り範囲を更新しない(映ったときに正しいコマへ戻る)
+			if (skipOffscreen && !texture->isVisible())
+			{
+				return;
+			}
 			nowClip = animFrame / keyFrameData % clipNumData;
 			Vector4 animRect = { clipData.xValue + clipData.wValue * nowClip,clipData.yValue,clipData.zValue,clipData.wValue };
 			texture->setSrcRect(animRect);
@@ -290,6 +384,11 @@ namespace ECS
 		{
 			clipNumData = clipNum;
 		}
+		//!@brief 画面外のときアニメーションの更新を飛ばすか設定します
+		[[noreturn]] void setSkipOffscreen(const bool skip) noexcept
+		{
+			skipOffscreen = skip;
+		}
 	private:
 		DrawTexture* texture;
 		Vector4 clipData;
@@ -297,18 +396,21 @@ namespace ECS
 		int animFrame;
 		int clipNumData;
 		int nowClip;
+		bool skipOffscreen;
 	};
 
 	//!@class BlendMode
+	//!@brief DrawTexture のブレンドモードと Alpha値を設定します
+	//!@note 設定が変わったフレームに BlendChangedEvent を発行し、DrawTexture は次のフレームに受け取ります
 	class BlendMode final : public ComponentSystem
 	{
 	public:
 		enum class Mode
 		{
-			None,		//uhȂ
-			AlphaBlend, //At@uh
-			Add,		//@a
-			Mod,		//ϒ
+			None,		//ブレンドなし
+			AlphaBlend, //アルファブレンド
+			Add,		//加法混和
+			Mod,		//変調
 		};
 	public:
 		explicit BlendMode() noexcept
@@ -328,19 +430,24 @@ namespace ECS
 		}
 		[[noreturn]] void initialize() noexcept override
 		{
-			texture = &entity->getComponent<DrawTexture>();
-			SDL_SetTextureBlendMode(texture->getValue(), blendMode);
+			changed = true;
 		}
+		//!@brief ブレンドモードと Alpha値は描画コマンドに含めて渡します
 		[[nodiscard]] void update() noexcept override
 		{
-			if (blendMode == SDL_BLENDMODE_NONE) { return; }
+			if (!changed)
+			{
+				return;
+			}
 			if (alphaBlendValue < 0) { alphaBlendValue = 0; }
 			if (alphaBlendValue > 255) { alphaBlendValue = 255; }
-			SDL_SetTextureAlphaMod(texture->getValue(), static_cast<Uint8>(alphaBlendValue));
+			const Uint8 alpha = blendMode == SDL_BLENDMODE_NONE ? 0xFF : static_cast<Uint8>(alphaBlendValue);
+			//キューがいっぱいなら次のフレームに送り直す
+			changed = !Event::EventBus::get().publish(Event::BlendChangedEvent{ entity->getHandle(), static_cast<std::uint32_t>(blendMode), alpha });
 		}
 		[[noreturn]] void draw2D() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
-		//!@brief uh[h̐ݒ
+		//!@brief ブレンドモードの設定
 		[[noreturn]] void setBlendMode(const Mode& mode) noexcept
 		{
 			switch (mode)
@@ -350,22 +457,24 @@ namespace ECS
 			case Mode::Add: blendMode = SDL_BLENDMODE_ADD; break;
 			case Mode::Mod: blendMode = SDL_BLENDMODE_MOD; break;
 			}
+			changed = true;
 		}
-		//!@brief Alphal̐ݒ
+		//!@brief Alpha値の設定
 		[[noreturn]] void setAlpha(const int alpha) noexcept
 		{
 			alphaBlendValue = alpha;
+			changed = true;
 		}
 	private:
 		SDL_BlendMode blendMode;
 		int alphaBlendValue;
-		DrawTexture* texture;
+		bool changed = true;
 	};
 
 	
 
 	//!@class ControlViewport
-	//!@brief r[|[g𐧌䂷
+	//!@brief ビューポートを制御する
 	class ControlViewport final : public ComponentSystem
 	{
 	public:
@@ -381,7 +490,7 @@ namespace ECS
 		[[noreturn]] void update() noexcept override {}
 		[[noreturn]] void draw2D() noexcept override
 		{
-			SDL_RenderSetViewport(&renderer->GetRenderer(), &viewportRect);
+			renderer->setViewport(viewportRect);
 		}
 		[[noreturn]] void draw3D() noexcept override {}
 		[[noreturn]] void setViewport(const Vector4& viewport) noexcept
@@ -395,4 +504,75 @@ namespace ECS
 		SDL_Rect viewportRect;
 		RendererSystem* renderer;
 	};
+
+	//!@class Camera2D
+	//!@brief ワールド座標の描画をビューポートへ映します
+	//!@note 複数置くと、それぞれのビューポートへ描画します(画面分割、ミニマップなど)
+	//!@note Rendererより前のEntityに付けてください
+	class Camera2D final : public ComponentSystem
+	{
+	public:
+		//!@brief [viewport]の左上にワールドの原点を映すカメラを作ります
+		explicit Camera2D(const Vector4& viewport, const int order = 0) noexcept
+		{
+			setViewport(viewport);
+			view.positionX = view.viewport.w * 0.5f;
+			view.positionY = view.viewport.h * 0.5f;
+			view.order = order;
+		}
+		void initialize() noexcept override
+		{
+			auto& engine = EntitySystemManager::get().getEntityManager("engine").getEntitiesByGroup(ENTITY_GROUP::Engine).at(0);
+			renderer = &engine->getComponent<RendererSystem>();
+		}
+		void update() noexcept override {}
+		void draw2D() noexcept override
+		{
+			renderer->addCamera(view);
+		}
+		void draw3D() noexcept override {}
+		//!@brief ビューポートの中心に映すワールド座標を設定します
+		void setPosition(const Vector2& position) noexcept
+		{
+			view.positionX = position.xValue;
+			view.positionY = position.yValue;
+		}
+		//!@brief 拡大率を設定します
+		void setZoom(const float zoom) noexcept
+		{
+			view.zoom = zoom > 0.0f ? zoom : view.zoom;
+		}
+		//!@brief 回転(度)を設定します
+		void setRotation(const float rotation) noexcept
+		{
+			view.rotation = rotation;
+		}
+		//!@brief ビューポートを設定します
+		void setViewport(const Vector4& viewport) noexcept
+		{
+			view.viewport.x = static_cast<int>(viewport.xValue);
+			view.viewport.y = static_cast<int>(viewport.yValue);
+			view.viewport.w = static_cast<int>(viewport.zValue);
+			view.viewport.h = static_cast<int>(viewport.wValue);
+		}
+		//!@brief 描画する順番を設定します(小さいものから)
+		void setOrder(const int order) noexcept
+		{
+			view.order = order;
+		}
+		//!@brief スクリーン(ビューポート内)の座標をワールド座標へ変換します
+		[[nodiscard]] Vector2 screenToWorld(const Vector2& point) const noexcept
+		{
+			const SDL_FPoint world = view.screenToWorld(point.xValue, point.yValue);
+			return Vector2(world.x, world.y);
+		}
+		//!@brief カメラの値を取得します
+		[[nodiscard]] const Render::CameraView& getView() const noexcept
+		{
+			return view;
+		}
+	private:
+		Render::CameraView view;
+		RendererSystem* renderer;
+	};
 }
\ No newline at end of file
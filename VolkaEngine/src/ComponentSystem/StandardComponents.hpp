@@ -1,22 +1,26 @@
 //---------------------------------------------------------
 //!@file StandardComponents.hpp
-//!@brief WIComponentQpӂ܂
+//!@brief 標準的なComponent群を用意します
 //!@author OxthLy
 //!@date 2018/11/3
-//!@note Position,Rotation,Scale,Transform Ȃ
-//!@note QlURL https://github.com/tonarinohito/MyGameTemplate/blob/master/gameTemple/src/Components/BasicComponents.hpp
+//!@note Position,Rotation,Scale,Transform など
+//!@note Position,Rotation,Scale,Color,Direction,Gravity はデータComponent(基底クラスなし)で、EntityManager のプールに詰めて置かれます
+//!@note データComponentを書き換えたら Entity::markChanged<T>() を呼んでください
+//!@note 参考URL https://github.com/tonarinohito/MyGameTemplate/blob/master/gameTemple/src/Components/BasicComponents.hpp
 //!@note by tonarinohito
 //---------------------------------------------------------
 #pragma once
 #include "../ECS/ECS.hpp"
+#include "../Event/EventBus.hpp"
+#include "../Event/Events.hpp"
 #include "../Utility/Vector.hpp"
 
 
 namespace ECS
 {
 	//!@class Position
-	//!@brief W܂
-	struct Position final : public ComponentData
+	//!@brief 座標を扱います
+	struct Position final
 	{
 		Position() = default;
 		explicit Position(const Vector3& vector3) noexcept
@@ -29,8 +33,8 @@ namespace ECS
 	};
 
 	//!@class Rotation
-	//!@brief ]܂
-	struct Rotation final : public ComponentData
+	//!@brief 回転を扱います
+	struct Rotation final
 	{
 		Rotation() = default;
 		explicit Rotation(const Vector3& vector3) noexcept
@@ -43,8 +47,8 @@ namespace ECS
 	};
 
 	//!@class Scale
-	//!@brief gk܂
-	struct Scale final : public ComponentData
+	//!@brief 拡大縮小を扱います
+	struct Scale final
 	{
 		Scale() = default;
 		explicit Scale(const Vector3& vector3) noexcept
@@ -57,7 +61,7 @@ namespace ECS
 	};
 
 	//!@class Transform
-	//!@brief WE]Egk̕ϊ܂
+	//!@brief 座標・回転・拡大縮小の変換を扱います
 	class Transform final : public ComponentSystem
 	{
 	public:
@@ -78,9 +82,21 @@ namespace ECS
 			{
 				entity->addComponent<Scale>();
 			}
-			pos = &entity->getComponent<Position>();
-			rot = &entity->getComponent<Rotation>();
-			sca = &entity->getComponent<Scale>();
+			observeSiblings();
+			rebind(pos, getComponentTypeID<Position>());
+			rebind(rot, getComponentTypeID<Rotation>());
+			rebind(sca, getComponentTypeID<Scale>());
+		}
+		//!@brief Position/Rotation/Scale が付け直されたら取り直します(削除されたら nullptr)
+		void onComponentAdded(const ComponentID id) override
+		{
+			onComponentRemoved(id);
+		}
+		void onComponentRemoved(const ComponentID id) override
+		{
+			rebind(pos, id);
+			rebind(rot, id);
+			rebind(sca, id);
 		}
 	private:
 		Position* pos;
@@ -89,16 +105,17 @@ namespace ECS
 	};
 
 	//!@class Color
-	//!@brief F܂
+	//!@brief 色を扱います
 	template<typename Type>
-	struct ColorType final : public ComponentData
+	struct ColorType final
 	{
 		explicit ColorType() noexcept
 		{}
 		explicit ColorType(const Type r, const Type g, const Type b, const Type a) noexcept
 			: value(r, g, b, a)
 		{}
-		//!@brief F̐ݒ
+		//!@brief 色の設定
+		//!@note 追加した後に変えたときは Entity::markChanged<ColorType>() も呼ぶか、Entity::setComponent<ColorType>() を使ってください
 		[[noreturn]] void setColor(const Vector4Type<Type>& color) noexcept
 		{
 			value = color;
@@ -109,11 +126,12 @@ namespace ECS
 	using Color16 = ColorType<Uint16>;
 	using Color32 = ColorType<Uint32>;
 	using Color64 = ColorType<Uint64>;
-	//ftHg Uint8
+	//デフォルトは Uint8
 	using Color = Color8;
 
 	//!@class Counter
-	//!@brief JEgs܂
+	//!@brief カウントを行います
+	//!@note 最大のカウントに達したフレームに CounterExpiredEvent を発行します(キューがいっぱいなら次のフレームに送り直します)
 	class Counter final : public ComponentSystem
 	{
 	public:
@@ -126,23 +144,29 @@ namespace ECS
 		[[noreturn]] void initialize() noexcept override
 		{
 			cnt = 0.0f;
+			expirePending = false;
 		}
 		[[noreturn]] void update() noexcept override
 		{
 			if (isMaxCount())
 			{
+				expirePending = true;
 				cnt = 0.0f;
 			}
 			++cnt;
+			if (expirePending)
+			{
+				expirePending = !Event::EventBus::get().publish(Event::CounterExpiredEvent{ entity->getHandle() });
+			}
 		}
 		[[noreturn]] void draw2D() noexcept override {}
 		[[noreturn]] void draw3D() noexcept override {}
-		//!@brief ő̃JEgǂ
+		//!@brief 最大のカウントかどうか
 		const bool isMaxCount() const noexcept
 		{
 			return cnt >= MaxCount;
 		}
-		//!@brief Zbg܂
+		//!@brief リセットします
 		[[noreturn]] void reset() noexcept
 		{
 			cnt = 0.0f;
@@ -150,10 +174,14 @@ namespace ECS
 	private:
 		float cnt;
 		const float MaxCount;
+		//発行できなかった CounterExpiredEvent がある
+		bool expirePending;
 	};
 
 	//!@class KillEntity
-	//!@brief A^b`Entityw莞Ԃō폜܂
+	//!@brief アタッチしたEntityを指定時間で削除します
+	//!@note Counter を直接見ずに、CounterExpiredEvent を受け取ったら削除します(発行の次のフレーム)
+	//!@note イベントは KillEntity ごとに読まず、1つの関数がフレームに1回ハンドルで宛先を引いて配ります
 	class KillEntity final : public ComponentSystem
 	{
 	public:
@@ -167,29 +195,34 @@ namespace ECS
 		{
 			if (!entity->hasComponent<Counter>())
 			{
-				entity->addComponent<Counter>();
-			}
-			counter = &entity->getComponent<Counter>();
-		}
-		[[noreturn]] void update() noexcept override
-		{
-			if (counter->isMaxCount())
-			{
-				entity->destroy();
+				entity->addComponent<Counter>(maxCountSpan);
 			}
+			static const bool subscribed = (Event::EventBus::get().subscribe<Event::CounterExpiredEvent>(onCounterExpired), true);
+			(void)subscribed;
 		}
+		[[noreturn]] void update() noexcept override {}
+		[[noreturn]] void draw2D() noexcept override {}
+		[[noreturn]] void draw3D() noexcept override {}
 		[[noreturn]] void setKillLimitTime(const float maxCount) noexcept
 		{
 			maxCountSpan = maxCount;
 		}
 	private:
-		Counter* counter;
+		static void onCounterExpired(const Event::CounterExpiredEvent& event)
+		{
+			Entity* target = EntityRegistry::get().find(event.entity);
+			if (target != nullptr && target->hasComponent<KillEntity>())
+			{
+				target->destroy();
+			}
+		}
+	private:
 		float maxCountSpan;
 	};
 
 	//!@class Direction
-	//!@brief ܂
-	struct Direction final : public ComponentData
+	//!@brief 向きを扱います
+	struct Direction final
 	{
 		enum class DirState : short
 		{
@@ -207,8 +240,8 @@ namespace ECS
 	};
 
 	//!@class Gravity
-	//!@brief d͂܂
-	struct Gravity final : public ComponentData
+	//!@brief 重力を扱います
+	struct Gravity final
 	{
 		explicit Gravity(const float gravity = DefaultGravity)
 			: value(gravity)
@@ -218,7 +251,7 @@ namespace ECS
 	};
 
 	//!@class Screen
-	//!@brief XN[܂
+	//!@brief スクリーンを扱います
 	class Screen final : public ComponentData
 	{
 	public:
@@ -231,15 +264,17 @@ namespace ECS
 		explicit Screen(const std::string& screenTitle,const Vector2& screenPos, const Vector2& screenSize) noexcept
 			: screenName(screenTitle),pos(screenPos), size(screenSize)
 		{}
-		//!@brief XN[̐ݒ
+		//!@brief スクリーン名の設定
 		[[noreturn]] void setScreenName(const std::string& screenTitle) noexcept
 		{
 			screenName = screenTitle;
+			markChanged();
 		}
-		//!@brief XN[̃TCY̐ݒ
+		//!@brief スクリーンのサイズの設定
 		[[noreturn]] void setScreenSize(const Vector2& screenSize) noexcept
 		{
 			size = screenSize;
+			markChanged();
 		}
 	public:
 		std::string screenName;
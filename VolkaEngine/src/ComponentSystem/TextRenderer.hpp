@@ -0,0 +1,119 @@
+//---------------------------------------------------------
+//!@file TextRenderer.hpp
+//!@brief 文字列を描画する Component を用意します
+//!@author Volka
+//!@date 2018/11/3
+//!@note 1つの文字列は1回のジオメトリで描画します(文字ごとの texture のコピーはしません)
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include "../ECS/ECS.hpp"
+#include "../ComponentSystem/EngineComponents.hpp"
+#include "../Render/BitmapFont.hpp"
+#include "../Render/DrawScene.hpp"
+
+namespace ECS
+{
+	//!@class TextRenderer
+	//!@brief engine の AssetFont に登録したフォントで文字列を描画します
+	class TextRenderer final : public ComponentSystem, public Render::GeometrySource
+	{
+	public:
+		explicit TextRenderer(const AssetFont::KeyTypeData& key, const std::string& str = "") noexcept
+			: accessKey(key), text(str)
+		{
+			position = Vector2(0.0f, 0.0f);
+			color = { 0xFF, 0xFF, 0xFF, 0xFF };
+			scale = 1.0f;
+			revision = 0;
+		}
+		void initialize() noexcept override
+		{
+			auto& engine = EntitySystemManager::get().getEntityManager("engine").getEntitiesByGroup(ENTITY_GROUP::Engine).at(0);
+			font = engine->getComponent<AssetFont>().getTexture(accessKey);
+			run = font->shape(text);
+			proxy.create();
+		}
+		void update() noexcept override {}
+		void draw2D() noexcept override
+		{
+			if (run->vertices.empty())
+			{
+				return;
+			}
+			Render::RenderCommand command;
+			command.type = Render::CommandType::Geometry;
+			command.texture = font->getTexture();
+			command.geometry = this;
+			command.revision = revision;
+			command.dst.x = static_cast<int>(std::floor(position.xValue));
+			command.dst.y = static_cast<int>(std::floor(position.yValue));
+			command.dst.w = static_cast<int>(std::ceil(run->width * scale)) + 1;
+			command.dst.h = static_cast<int>(std::ceil(run->height * scale)) + 1;
+			Render::DrawScene::get().update(proxy, command, command.dst);
+		}
+		void draw3D() noexcept override {}
+		std::size_t getVertexCount(const std::uint32_t /*part*/) override
+		{
+			return run->vertices.size();
+		}
+		//!@brief 並べ終わった頂点を位置・拡大率・色に合わせて書き込みます
+		void writeVertices(const std::uint32_t /*part*/, SDL_Vertex* out) override
+		{
+			for (const auto& vertex : run->vertices)
+			{
+				out->position.x = position.xValue + vertex.position.x * scale;
+				out->position.y = position.yValue + vertex.position.y * scale;
+				out->color = color;
+				out->tex_coord = vertex.tex_coord;
+				++out;
+			}
+		}
+		//!@brief 文字列を設定します(変わったときだけ並べ直します)
+		void setText(const std::string& str)
+		{
+			if (str == text)
+			{
+				return;
+			}
+			text = str;
+			run = font->shape(text);
+			++revision;
+		}
+		//!@brief 左上の位置を設定します
+		void setPosition(const Vector2& pos) noexcept
+		{
+			position = pos;
+			++revision;
+		}
+		//!@brief 色を設定します
+		void setColor(const SDL_Color& textColor) noexcept
+		{
+			color = textColor;
+			++revision;
+		}
+		//!@brief 拡大率を設定します
+		void setScale(const float textScale) noexcept
+		{
+			scale = textScale;
+			++revision;
+		}
+		[[nodiscard]] const std::string& getText() const noexcept
+		{
+			return text;
+		}
+	private:
+		AssetFont::KeyTypeData accessKey;
+		std::shared_ptr<Render::BitmapFont> font;
+		std::shared_ptr<const Render::TextRun> run;
+		std::string text;
+		Vector2 position;
+		SDL_Color color;
+		float scale;
+		std::uint32_t revision;
+		Render::ProxyHandle proxy;
+	};
+}
\ No newline at end of file
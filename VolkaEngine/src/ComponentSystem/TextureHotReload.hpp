@@ -0,0 +1,183 @@
+//---------------------------------------------------------
+//!@file TextureHotReload.hpp
+//!@brief 画像ファイルが書き換えられたら texture を作り直します
+//!@author Volka
+//!@date 2018/11/3
+//!@note デコードは専用のスレッドで行い、texture の差し替えは update() (フレームの区切り)で行います
+//!@note update() はワーカーで呼ばれるので、texture の作成は RendererSystem::invoke() でメインスレッドに頼みます
+//!@note TextureHandle はそのまま使えるので、DrawTexture などは登録し直さなくても新しい画像を描画します
+//!@note 開発中に使うものです(カラーキーは反映されません)
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <SDL2_image/SDL_image.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EngineComponents.hpp"
+#include "../Render/PixelConvert.hpp"
+#include "../Utility/FileWatcher.hpp"
+
+namespace ECS
+{
+	//!@class TextureHotReload
+	//!@brief AssetTexture にファイルから登録した画像を監視し、変更されたら差し替えます
+	//!@note AssetTexture と RendererSystem と同じEntityに追加してください
+	class TextureHotReload final : public ComponentSystem
+	{
+	public:
+		virtual ~TextureHotReload()
+		{
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				running = false;
+			}
+			condition.notify_all();
+			if (thread.joinable())
+			{
+				thread.join();
+			}
+			for (auto& result : results)
+			{
+				SDL_FreeSurface(result.surface);
+			}
+		}
+		[[noreturn]] void initialize() noexcept override
+		{
+			cache = &entity->getComponent<AssetTexture>();
+			renderer = &entity->getComponent<RendererSystem>();
+			revision = cache->getRevision() - 1;
+			running = true;
+			thread = std::thread([this]() { run(); });
+		}
+		[[noreturn]] void update() noexcept override
+		{
+			if (cache->getRevision() != revision)
+			{
+				revision = cache->getRevision();
+				cache->getFiles(filePaths);
+				for (const auto& filePath : filePaths)
+				{
+					watcher.watch(filePath);
+				}
+			}
+			watcher.poll(filePaths);
+			if (!filePaths.empty())
+			{
+				{
+					std::lock_guard<std::mutex> guard(mutex);
+					requests.insert(requests.end(), filePaths.begin(), filePaths.end());
+				}
+				condition.notify_one();
+			}
+			swapDecoded();
+		}
+		[[noreturn]] void draw2D() noexcept override {}
+		[[noreturn]] void draw3D() noexcept override {}
+		//!@brief 読み込み直した画像を乗算済みアルファにするか設定します
+		//!@note CreateTexture::setPremultipliedAlpha() と同じ値にしてください
+		[[noreturn]] void setPremultipliedAlpha(const bool isPremultiplied) noexcept
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			premultiplied = isPremultiplied;
+		}
+	private:
+		struct Result
+		{
+			std::string filePath;
+			SDL_Surface* surface;
+			bool premultiplied;
+		};
+		//!@brief デコードが終わったものを texture にして差し替えます
+		void swapDecoded()
+		{
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				if (results.empty())
+				{
+					return;
+				}
+				swapping.swap(results);
+			}
+			for (auto& result : swapping)
+			{
+				SDL_Texture* texture = nullptr;
+				renderer->invoke([this, &result, &texture]()
+				{
+					texture = Render::CreateTexture(&renderer->GetRenderer(), result.surface, result.premultiplied);
+				});
+				SDL_FreeSurface(result.surface);
+				if (texture == nullptr)
+				{
+					std::cerr << result.filePath << ": " << SDL_GetError() << std::endl;
+					continue;
+				}
+				if (cache->swapFile(result.filePath, texture))
+				{
+					std::cout << "reloaded: " << result.filePath << std::endl;
+				}
+			}
+			swapping.clear();
+			//同じアドレスに作られると変更に気づけないので、画面全体を描き直す
+			renderer->invalidateScreen();
+		}
+		//!@brief デコードするスレッド
+		void run()
+		{
+			for (;;)
+			{
+				std::string filePath;
+				bool isPremultiplied;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [this]() { return !requests.empty() || !running; });
+					if (!running)
+					{
+						return;
+					}
+					filePath = std::move(requests.front());
+					requests.pop_front();
+					isPremultiplied = premultiplied;
+				}
+				SDL_Surface* surface = decode(filePath, isPremultiplied);
+				if (surface == nullptr)
+				{
+					continue;
+				}
+				std::lock_guard<std::mutex> guard(mutex);
+				results.push_back({ filePath, surface, isPremultiplied });
+			}
+		}
+		//!@brief [filePath]を読み込み、texture と同じ形式(Render::TextureFormat)にします
+		static SDL_Surface* decode(const std::string& filePath, const bool isPremultiplied)
+		{
+			SDL_Surface* loadSurface = IMG_Load(filePath.c_str());
+			if (loadSurface == nullptr)
+			{
+				//書き込みの途中なら次の通知で読み直す
+				std::cerr << filePath << ": " << IMG_GetError() << std::endl;
+				return nullptr;
+			}
+			SDL_Surface* surface = Render::NormalizeSurface(loadSurface, isPremultiplied);
+			SDL_FreeSurface(loadSurface);
+			return surface;
+		}
+	private:
+		AssetTexture* cache;
+		RendererSystem* renderer;
+		FileWatcher watcher;
+		std::vector<std::string> filePaths;
+		std::uint32_t revision;
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<std::string> requests;
+		std::vector<Result> results;
+		std::vector<Result> swapping;
+		bool running;
+		bool premultiplied = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,247 @@
+//---------------------------------------------------------
+//!@file Tilemap.hpp
+//!@brief タイルマップのComponentを用意します
+//!@author Volka
+//!@date 2018/11/3
+//!@note タイルはチャンクごとに持ち、チャンクごとに1回のジオメトリで描画します
+//!@note 頂点は画面に映ったチャンクだけ作り、書き換えたチャンクだけ作り直します
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "../ECS/ECS.hpp"
+#include "../ComponentSystem/EngineComponents.hpp"
+#include "../Render/DrawScene.hpp"
+
+namespace ECS
+{
+	//!@class Tilemap
+	//!@brief [tileSize]四方のタイルを[width]x[height]並べたマップ
+	//!@note タイル番号は 1 から始まり、タイルセットの左上から右へ数えます(0 は何も描かない)
+	class Tilemap final : public ComponentSystem, public Render::GeometrySource
+	{
+	public:
+		using TileID = std::uint16_t;
+		static constexpr TileID EmptyTile = 0;
+		//1チャンクのタイル数(一辺)
+		static constexpr int ChunkSize = 32;
+		//このフレーム数描画されなかったチャンクは頂点を解放します
+		static constexpr std::uint64_t EvictFrames = 300;
+	public:
+		//!@param key タイルセットの texture
+		//!@param columns タイルセットの横のタイル数
+		explicit Tilemap(const AssetTexture::KeyTypeData& key, const int width, const int height, const int tileSize, const int columns) noexcept
+			: accessKey(key), mapWidth(width), mapHeight(height), tileSizeData(tileSize), tilesetColumns(columns)
+		{
+			chunkX = (width + ChunkSize - 1) / ChunkSize;
+			chunkY = (height + ChunkSize - 1) / ChunkSize;
+			chunks.resize(static_cast<std::size_t>(chunkX) * chunkY);
+		}
+		void initialize() noexcept override
+		{
+			auto& engine = EntitySystemManager::get().getEntityManager("engine").getEntitiesByGroup(ENTITY_GROUP::Engine).at(0);
+			texture = engine->getComponent<AssetTexture>().acquire(accessKey);
+			textureWidth = 1;
+			textureHeight = 1;
+			SDL_QueryTexture(texture.get(), nullptr, nullptr, &textureWidth, &textureHeight);
+			frame = 0;
+		}
+		void update() noexcept override
+		{
+			++frame;
+			if (frame % 60 != 0)
+			{
+				return;
+			}
+			for (auto& chunk : chunks)
+			{
+				if (!chunk.vertices.empty() && frame - chunk.lastUsedFrame > EvictFrames)
+				{
+					chunk.vertices.clear();
+					chunk.vertices.shrink_to_fit();
+					chunk.dirty = true;
+				}
+			}
+		}
+		void draw2D() noexcept override
+		{
+			auto& scene = Render::DrawScene::get();
+			Render::RenderCommand command;
+			command.type = Render::CommandType::Geometry;
+			command.texture = texture.get();
+			command.geometry = this;
+			for (std::size_t i = 0; i < chunks.size(); ++i)
+			{
+				Chunk& chunk = chunks[i];
+				if (chunk.tileNum == 0)
+				{
+					continue;
+				}
+				if (chunk.proxy == Render::InvalidProxy)
+				{
+					chunk.proxy.create();
+				}
+				command.dst = getChunkRect(i);
+				command.part = static_cast<std::uint32_t>(i);
+				command.revision = chunk.revision;
+				scene.update(chunk.proxy, command, command.dst);
+			}
+		}
+		void draw3D() noexcept override {}
+		//!@brief チャンクの頂点数を取得します(書き換えられていれば作り直します)
+		std::size_t getVertexCount(const std::uint32_t part) override
+		{
+			Chunk& chunk = chunks[part];
+			if (chunk.dirty)
+			{
+				build(part);
+			}
+			chunk.lastUsedFrame = frame;
+			return chunk.vertices.size();
+		}
+		//!@brief チャンクの頂点をコピーします
+		void writeVertices(const std::uint32_t part, SDL_Vertex* out) override
+		{
+			const Chunk& chunk = chunks[part];
+			std::memcpy(out, chunk.vertices.data(), chunk.vertices.size() * sizeof(SDL_Vertex));
+		}
+		//!@brief ([x], [y])のタイルを設定します
+		void setTile(const int x, const int y, const TileID tile) noexcept
+		{
+			if (x < 0 || y < 0 || x >= mapWidth || y >= mapHeight)
+			{
+				return;
+			}
+			Chunk& chunk = chunks[static_cast<std::size_t>(y / ChunkSize) * chunkX + x / ChunkSize];
+			if (chunk.tiles.empty())
+			{
+				if (tile == EmptyTile)
+				{
+					return;
+				}
+				chunk.tiles.assign(ChunkSize * ChunkSize, EmptyTile);
+			}
+			TileID& current = chunk.tiles[static_cast<std::size_t>(y % ChunkSize) * ChunkSize + x % ChunkSize];
+			if (current == tile)
+			{
+				return;
+			}
+			if (current == EmptyTile) { ++chunk.tileNum; }
+			if (tile == EmptyTile) { --chunk.tileNum; }
+			current = tile;
+			chunk.dirty = true;
+			++chunk.revision;
+			if (chunk.tileNum == 0)
+			{
+				chunk.proxy.reset();
+			}
+		}
+		//!@brief ([x], [y])から[width]x[height]の範囲を[tile]で埋めます
+		void fill(const int x, const int y, const int width, const int height, const TileID tile) noexcept
+		{
+			for (int ty = y; ty < y + height; ++ty)
+			{
+				for (int tx = x; tx < x + width; ++tx)
+				{
+					setTile(tx, ty, tile);
+				}
+			}
+		}
+		//!@brief ([x], [y])のタイルを取得します
+		[[nodiscard]] TileID getTile(const int x, const int y) const noexcept
+		{
+			if (x < 0 || y < 0 || x >= mapWidth || y >= mapHeight)
+			{
+				return EmptyTile;
+			}
+			const Chunk& chunk = chunks[static_cast<std::size_t>(y / ChunkSize) * chunkX + x / ChunkSize];
+			if (chunk.tiles.empty())
+			{
+				return EmptyTile;
+			}
+			return chunk.tiles[static_cast<std::size_t>(y % ChunkSize) * ChunkSize + x % ChunkSize];
+		}
+		//!@brief ワールド座標をタイルの位置に変換します
+		[[nodiscard]] SDL_Point worldToTile(const Vector2& position) const noexcept
+		{
+			return { static_cast<int>(position.xValue) / tileSizeData, static_cast<int>(position.yValue) / tileSizeData };
+		}
+		[[nodiscard]] int getWidth() const noexcept { return mapWidth; }
+		[[nodiscard]] int getHeight() const noexcept { return mapHeight; }
+		[[nodiscard]] int getTileSize() const noexcept { return tileSizeData; }
+	private:
+		struct Chunk
+		{
+			std::vector<TileID> tiles;			//最初にタイルを置いたときに確保
+			std::vector<SDL_Vertex> vertices;	//描画されたときに作る
+			std::uint64_t lastUsedFrame = 0;
+			std::uint32_t revision = 0;
+			std::uint32_t tileNum = 0;
+			Render::ProxyHandle proxy;
+			bool dirty = true;
+		};
+		//!@brief チャンクのワールド座標での範囲
+		SDL_Rect getChunkRect(const std::size_t index) const noexcept
+		{
+			const int cx = static_cast<int>(index % chunkX);
+			const int cy = static_cast<int>(index / chunkX);
+			const int tileW = std::min(ChunkSize, mapWidth - cx * ChunkSize);
+			const int tileH = std::min(ChunkSize, mapHeight - cy * ChunkSize);
+			return { cx * ChunkSize * tileSizeData, cy * ChunkSize * tileSizeData, tileW * tileSizeData, tileH * tileSizeData };
+		}
+		//!@brief チャンクの頂点(1タイル2枚の三角形)を作ります
+		void build(const std::size_t index)
+		{
+			Chunk& chunk = chunks[index];
+			chunk.vertices.clear();
+			chunk.vertices.reserve(static_cast<std::size_t>(chunk.tileNum) * 6);
+			const SDL_Rect rect = getChunkRect(index);
+			const float size = static_cast<float>(tileSizeData);
+			const float u = size / static_cast<float>(textureWidth);
+			const float v = size / static_cast<float>(textureHeight);
+			const SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+			for (int y = 0; y < ChunkSize; ++y)
+			{
+				for (int x = 0; x < ChunkSize; ++x)
+				{
+					const TileID tile = chunk.tiles[static_cast<std::size_t>(y) * ChunkSize + x];
+					if (tile == EmptyTile)
+					{
+						continue;
+					}
+					const float left = static_cast<float>(rect.x) + x * size;
+					const float top = static_cast<float>(rect.y) + y * size;
+					const float u0 = static_cast<float>((tile - 1) % tilesetColumns) * u;
+					const float v0 = static_cast<float>((tile - 1) / tilesetColumns) * v;
+					const SDL_Vertex lt = { { left, top }, white, { u0, v0 } };
+					const SDL_Vertex rt = { { left + size, top }, white, { u0 + u, v0 } };
+					const SDL_Vertex lb = { { left, top + size }, white, { u0, v0 + v } };
+					const SDL_Vertex rb = { { left + size, top + size }, white, { u0 + u, v0 + v } };
+					chunk.vertices.push_back(lt);
+					chunk.vertices.push_back(rt);
+					chunk.vertices.push_back(lb);
+					chunk.vertices.push_back(rt);
+					chunk.vertices.push_back(rb);
+					chunk.vertices.push_back(lb);
+				}
+			}
+			chunk.dirty = false;
+		}
+	private:
+		AssetTexture::KeyTypeData accessKey;
+		TextureHandle texture;
+		std::vector<Chunk> chunks;
+		std::uint64_t frame;
+		int mapWidth;
+		int mapHeight;
+		int tileSizeData;
+		int tilesetColumns;
+		int chunkX;
+		int chunkY;
+		int textureWidth;
+		int textureHeight;
+	};
+}
\ No newline at end of file
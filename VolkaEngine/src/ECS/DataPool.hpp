@@ -0,0 +1,219 @@
+//---------------------------------------------------------
+//!@file DataPool.hpp
+//!@brief データComponent(ComponentSystem を継承しない構造体)を型ごとに詰めて置くプール
+//!@author Volka
+//!@date 2018/11/3
+//!@note 値は固定サイズのページに隙間なく並び、vtable や Entity へのポインタなどのヘッダーを持ちません
+//!@note 追加・変更の時刻と持ち主は値とは別の列に置きます。ページは動かないので、値へのポインタは削除されるまで有効です
+//---------------------------------------------------------
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ECS
+{
+	class Entity;
+
+	//!@class DataPage
+	//!@brief 1つの型の値の列と、値ごとの追加・変更の時刻、持ち主の列を持つページ
+	//!@note ページは PageSize に揃えて確保するので、値のアドレスからページと番号が分かります
+	struct DataPage final
+	{
+		static constexpr std::size_t PageSize = 16 * 1024;
+		std::uint32_t capacity;
+		//一度でも使った番号の数(走査はここまで)
+		std::uint32_t used;
+		std::uint32_t elementSize;
+		std::byte* values;
+		std::uint32_t* addedTicks;
+		std::uint32_t* changedTicks;
+		//空いている番号は nullptr
+		Entity** owners;
+
+		//!@brief [value]が置かれているページ
+		[[nodiscard]] static DataPage& of(const void* value) noexcept
+		{
+			return *reinterpret_cast<DataPage*>(reinterpret_cast<std::uintptr_t>(value) & ~static_cast<std::uintptr_t>(PageSize - 1));
+		}
+		//!@brief [value]のページの中での番号
+		[[nodiscard]] std::uint32_t indexOf(const void* value) const noexcept
+		{
+			return static_cast<std::uint32_t>((static_cast<const std::byte*>(value) - values) / elementSize);
+		}
+		[[nodiscard]] void* at(const std::uint32_t index) const noexcept
+		{
+			return values + static_cast<std::size_t>(index) * elementSize;
+		}
+		//!@brief [value]が追加された時刻
+		[[nodiscard]] static std::uint32_t& addedTickOf(const void* value) noexcept
+		{
+			DataPage& page = of(value);
+			return page.addedTicks[page.indexOf(value)];
+		}
+		//!@brief [value]が最後に変更(追加も含む)された時刻
+		[[nodiscard]] static std::uint32_t& changedTickOf(const void* value) noexcept
+		{
+			DataPage& page = of(value);
+			return page.changedTicks[page.indexOf(value)];
+		}
+	};
+
+	//!@class DataPoolBase
+	//!@brief 型を知らなくても使えるプールの部分(Prefab・シリアライズ・Entityの解放から使います)
+	class DataPoolBase
+	{
+	public:
+		DataPoolBase(const std::size_t size, const std::size_t align) noexcept
+			: elementSize(size), alignment(align)
+		{}
+		DataPoolBase(const DataPoolBase&) = delete;
+		DataPoolBase& operator=(const DataPoolBase&) = delete;
+		//!@brief 値の破棄は DataPool<T> が先に行います
+		virtual ~DataPoolBase()
+		{
+			for (DataPage* page : pages)
+			{
+				page->~DataPage();
+				::operator delete(page, std::align_val_t(DataPage::PageSize));
+			}
+		}
+		//!@brief [source]のコピーを[owner]の値として置きます
+		[[nodiscard]] virtual void* clone(Entity& owner, const std::uint32_t tick, const void* source) = 0;
+		//!@brief [value]を持ち主から外します(値は free() するまで読めます)
+		void detach(void* value) noexcept
+		{
+			DataPage& page = DataPage::of(value);
+			page.owners[page.indexOf(value)] = nullptr;
+			--count;
+		}
+		//!@brief detach() した[value]を破棄して番号を空けます
+		void free(void* value)
+		{
+			destroy(value);
+			freeList.emplace_back(value);
+		}
+		//!@brief 持ち主のいる値の数
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return count;
+		}
+		//!@brief 持ち主のいる値をページの順にすべて[func](Entity&, void*)で処理します
+		template <typename Func> void each(Func&& func) const
+		{
+			for (const DataPage* page : pages)
+			{
+				for (std::uint32_t i = 0; i < page->used; ++i)
+				{
+					if (page->owners[i] != nullptr)
+					{
+						func(*page->owners[i], page->at(i));
+					}
+				}
+			}
+		}
+	protected:
+		virtual void destroy(void* value) noexcept = 0;
+		//!@brief 空いている番号を[owner]に割り当てて、値を置くアドレスを返します
+		[[nodiscard]] void* acquire(Entity& owner, const std::uint32_t tick)
+		{
+			void* value = nullptr;
+			if (!freeList.empty())
+			{
+				value = freeList.back();
+				freeList.pop_back();
+			}
+			else
+			{
+				if (pages.empty() || pages.back()->used == pages.back()->capacity)
+				{
+					addPage();
+				}
+				DataPage& page = *pages.back();
+				value = page.at(page.used++);
+			}
+			DataPage& page = DataPage::of(value);
+			const std::uint32_t index = page.indexOf(value);
+			page.owners[index] = &owner;
+			page.addedTicks[index] = tick;
+			page.changedTicks[index] = tick;
+			++count;
+			return value;
+		}
+	private:
+		static std::size_t alignUp(const std::size_t offset, const std::size_t align) noexcept
+		{
+			return (offset + align - 1) / align * align;
+		}
+		//!@brief ページを1枚確保して、値・時刻・持ち主の列に分けます
+		void addPage()
+		{
+			void* memory = ::operator new(DataPage::PageSize, std::align_val_t(DataPage::PageSize));
+			DataPage* page = new (memory) DataPage;
+			std::byte* base = static_cast<std::byte*>(memory);
+			std::size_t offset = alignUp(sizeof(DataPage), alignment);
+			//列の間を揃えるための隙間の分を引いておく
+			const std::size_t perElement = elementSize + sizeof(std::uint32_t) * 2 + sizeof(Entity*);
+			page->capacity = static_cast<std::uint32_t>((DataPage::PageSize - offset - alignof(std::uint32_t) - alignof(Entity*)) / perElement);
+			page->used = 0;
+			page->elementSize = static_cast<std::uint32_t>(elementSize);
+			page->values = base + offset;
+			offset = alignUp(offset + elementSize * page->capacity, alignof(std::uint32_t));
+			page->addedTicks = reinterpret_cast<std::uint32_t*>(base + offset);
+			offset += sizeof(std::uint32_t) * page->capacity;
+			page->changedTicks = reinterpret_cast<std::uint32_t*>(base + offset);
+			offset = alignUp(offset + sizeof(std::uint32_t) * page->capacity, alignof(Entity*));
+			page->owners = reinterpret_cast<Entity**>(base + offset);
+			assert(offset + sizeof(Entity*) * page->capacity <= DataPage::PageSize);
+			pages.emplace_back(page);
+		}
+	protected:
+		std::vector<DataPage*> pages;
+	private:
+		std::vector<void*> freeList;
+		std::size_t count = 0;
+		std::size_t elementSize;
+		std::size_t alignment;
+	};
+
+	//!@class DataPool
+	//!@brief データComponent T のプール(EntityManager ごとに1つ)
+	template <typename T>
+	class DataPool final : public DataPoolBase
+	{
+		static_assert(sizeof(T) <= DataPage::PageSize / 16, "data component is too large for DataPage");
+		static_assert(alignof(T) <= alignof(std::max_align_t), "data component alignment is too large");
+	public:
+		DataPool() noexcept
+			: DataPoolBase(sizeof(T), alignof(T))
+		{}
+		~DataPool() override
+		{
+			each([](Entity&, void* value) { static_cast<T*>(value)->~T(); });
+		}
+		//!@brief [owner]の値を[args]で作ります
+		template <typename... TArgs> [[nodiscard]] T* emplace(Entity& owner, const std::uint32_t tick, TArgs&&... args)
+		{
+			return new (acquire(owner, tick)) T(std::forward<TArgs>(args)...);
+		}
+		[[nodiscard]] void* clone(Entity& owner, const std::uint32_t tick, const void* source) override
+		{
+			return emplace(owner, tick, *static_cast<const T*>(source));
+		}
+		//!@brief 持ち主のいる値をページの順にすべて[func](Entity&, T&)で処理します
+		template <typename Func> void forEach(Func&& func) const
+		{
+			each([&func](Entity& owner, void* value) { func(owner, *static_cast<T*>(value)); });
+		}
+	private:
+		void destroy(void* value) noexcept override
+		{
+			static_cast<T*>(value)->~T();
+		}
+	};
+}
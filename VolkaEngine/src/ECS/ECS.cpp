@@ -4,4 +4,75 @@ void ECS::Entity::addGroup(Group group) noexcept
 {
 	groupBitSet[group] = true;
 	manager_.addToGroup(this, group);
-}
\ No newline at end of file
+}
+ECS::Entity::~Entity()
+{
+	//解放中のEntityはハンドルから引けないようにする
+	EntityRegistry::get().remove(handle);
+	for (const auto& c : components)
+	{
+		onComponentFreed(c->typeID);
+	}
+	//後から追加したComponentは先に追加したものを使うので、追加の逆順に解放する
+	//(RendererSystem の描画スレッドと SDL_Renderer を、WindowSystem の SDL_DestroyWindow/SDL_Quit より先に片付ける)
+	while (!components.empty())
+	{
+		components.pop_back();
+	}
+	//データComponentはプールに返す(削除済みのものは EntityManager が返す)
+	for (ComponentID id = 0; id < MaxComponents; ++id)
+	{
+		if (componentBitSet[id] && isDataComponentType(id))
+		{
+			DataPoolBase& pool = manager_.getDataPool(id);
+			pool.detach(componentArray[id]);
+			pool.free(componentArray[id]);
+			onComponentFreed(id);
+		}
+	}
+	manager_.getMemoryCounter().onFree(sizeof(Entity));
+}
+
+void ECS::Entity::onComponentAllocated(ComponentID id, std::size_t size) noexcept
+{
+	Memory::MemoryTracker::get().getTypeCounter(id).onAllocate(size);
+	manager_.getMemoryCounter().onAllocate(size);
+}
+
+void ECS::Entity::onComponentFreed(ComponentID id) noexcept
+{
+	const std::size_t size = Memory::MemoryTracker::get().getTypeSize(id);
+	Memory::MemoryTracker::get().getTypeCounter(id).onFree(size);
+	manager_.getMemoryCounter().onFree(size);
+}
+
+void ECS::Entity::onComponentChanged(ComponentID id, std::uint32_t tick, bool added) noexcept
+{
+	manager_.onComponentChanged(id, tick, added);
+}
+
+void ECS::Entity::onComponentEvent(ComponentID id, ComponentEvent event)
+{
+	manager_.queueComponentEvent(*this, id, event);
+}
+
+void ECS::Entity::onDataRemoved(ComponentID id)
+{
+	manager_.onDataRemoved(*this, id, componentArray[id]);
+}
+
+void ECS::ComponentSystem::markChanged() noexcept
+{
+	changedTick = getChangeTick();
+	//Prefab の原型などEntityについていないものは、追加されたときに記録される
+	if (entity != nullptr)
+	{
+		entity->onComponentChanged(typeID, changedTick, false);
+	}
+}
+
+void ECS::ComponentSystem::observeSiblings() noexcept
+{
+	observing = true;
+	entity->siblingObserved = true;
+}
@@ -1,9 +1,9 @@
 //---------------------------------------------------------
 //!@file ECS.hpp
-//!@brief EntityComponentSystem̎ԂłB
+//!@brief EntityComponentSystemの実態です。
 //!@author Volka
 //!@date 2018/11/3
-//!@note Ql https ://github.com/SuperV1234/Tutorials
+//!@note 参考元 https ://github.com/SuperV1234/Tutorials
 //---------------------------------------------------------
 #pragma once
 #include <bitset>
@@ -13,8 +13,25 @@
 #include <assert.h>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <type_traits>
+#include <typeinfo>
+#include "../Memory/Allocator.hpp"
+#include "../Memory/AllocationHook.hpp"
+#include "../Memory/MemoryTracker.hpp"
+#include "../Telemetry/FrameTelemetry.hpp"
+#include "../Event/EventBus.hpp"
+#include "../Event/Events.hpp"
+#include "Tag.hpp"
+#include "EntityHandle.hpp"
+#include "DataPool.hpp"
+#include "../Job/JobSystem.hpp"
+#include "../Job/MainThread.hpp"
+#include "../Utility/Runtime.hpp"
 
 namespace ECS
 {
@@ -26,45 +43,223 @@ namespace ECS
 	using Group = std::size_t;
 
 
+	//!@brief ワールドを並列に更新するので、型IDの発行はスレッドセーフにしておく
 	inline ComponentID getNewComponentTypeID() noexcept
 	{
-		static ComponentID lastID = 0;
+		static std::atomic<ComponentID> lastID{ 0 };
 		return ++lastID;
 	}
 
+	constexpr std::size_t MaxComponents = 64;
+	static_assert(MaxComponents <= Memory::MemoryTracker::MaxTypes, "MemoryTracker cannot track all component types");
+
+	//!@brief ComponentSystem を継承しない型はデータComponentです
+	//!@note データComponentは vtable などのヘッダーを持たず、EntityManager の型ごとのプール(DataPool)に詰めて置かれます
+	template <typename T> constexpr bool IsDataComponent = !std::is_base_of_v<ComponentSystem, T>;
+
+	//!@brief データComponentの型ごとの操作(型を知らない EntityManager と Prefab から使います)
+	struct DataComponentOps
+	{
+		DataPoolBase* (*createPool)();
+		std::shared_ptr<void> (*copy)(const void*);
+	};
+
+	//!@brief 型IDごとのデータComponentの操作(ComponentSystem の型は nullptr)
+	inline std::array<const DataComponentOps*, MaxComponents>& getDataComponentOpsTable() noexcept
+	{
+		static std::array<const DataComponentOps*, MaxComponents> opsTable{};
+		return opsTable;
+	}
+
+	template <typename T> const DataComponentOps* getDataComponentOps() noexcept
+	{
+		if constexpr (IsDataComponent<T>)
+		{
+			static_assert(std::is_copy_constructible_v<T>, "data component must be copy constructible");
+			static const DataComponentOps ops =
+			{
+				[]() -> DataPoolBase* { return new DataPool<T>(); },
+				[](const void* source) -> std::shared_ptr<void> { return std::make_shared<T>(*static_cast<const T*>(source)); },
+			};
+			return &ops;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
+	//!@brief [id]の型がデータComponentか
+	inline bool isDataComponentType(const ComponentID id) noexcept
+	{
+		return getDataComponentOpsTable()[id] != nullptr;
+	}
+
+	//!@brief Componentを複製する関数(Prefabで使います)
+	using CloneFunc = ComponentSystem* (*)(const ComponentSystem&);
+
+	//!@brief 型IDごとの複製関数(コピーできない型は nullptr)
+	inline std::array<CloneFunc, MaxComponents>& getCloneFuncTable() noexcept
+	{
+		static std::array<CloneFunc, MaxComponents> cloneFuncTable{};
+		return cloneFuncTable;
+	}
+
+	template <typename T> ComponentSystem* cloneComponent(const ComponentSystem& source)
+	{
+		return new T(static_cast<const T&>(source));
+	}
+
+	template <typename T> constexpr CloneFunc getCloneFunc() noexcept
+	{
+		if constexpr (!IsDataComponent<T> && std::is_copy_constructible_v<T>)
+		{
+			return &cloneComponent<T>;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
+	//!@brief 新しい型IDを発行し、メモリの記録用に名前とサイズを、複製用に[clone]を、データComponentなら[ops]を登録します
+	inline ComponentID registNewComponentType(const char* name, const std::size_t size, const CloneFunc clone, const DataComponentOps* ops) noexcept
+	{
+		const ComponentID typeID = getNewComponentTypeID();
+		Memory::MemoryTracker::get().registType(typeID, name, size);
+		getCloneFuncTable()[typeID] = clone;
+		getDataComponentOpsTable()[typeID] = ops;
+		return typeID;
+	}
+
 	template <typename T> inline ComponentID getComponentTypeID() noexcept
 	{
-		static ComponentID typeID = getNewComponentTypeID();
+		static ComponentID typeID = registNewComponentType(typeid(T).name(), sizeof(T), getCloneFunc<T>(), getDataComponentOps<T>());
 		return typeID;
 	}
 
-	constexpr std::size_t MaxComponents = 64;
 	constexpr std::size_t MaxGroups = 32;
 
+	//!@brief Componentの追加・変更を記録する時刻のカウンタ(ChangeCursor::next() のたびに進みます)
+	inline std::atomic<std::uint32_t>& getChangeTickCounter() noexcept
+	{
+		static std::atomic<std::uint32_t> changeTick{ 1 };
+		return changeTick;
+	}
+	//!@brief 今の変更の時刻
+	inline std::uint32_t getChangeTick() noexcept
+	{
+		return getChangeTickCounter().load(std::memory_order_relaxed);
+	}
+
+	//!@class ChangeCursor
+	//!@brief 変更を読む側が持ち、前回読んだ後の追加・変更だけを取り出すための印
+	//!@note 読む前に毎回 next() を呼びます。最初の next() の後はすべてが対象になります
+	class ChangeCursor final
+	{
+	public:
+		//!@brief 前回の next() から今までを読む範囲にします
+		void next() noexcept
+		{
+			since = until;
+			until = getChangeTickCounter().fetch_add(1, std::memory_order_relaxed);
+		}
+		//!@brief この時刻より後の追加・変更が対象です
+		[[nodiscard]] std::uint32_t getSince() const noexcept
+		{
+			return since;
+		}
+	private:
+		std::uint32_t since = 0;
+		std::uint32_t until = 0;
+	};
+
+	//!@brief クエリの条件: ChangeCursor の前回から追加された T
+	template <typename T> struct Added
+	{
+		using Type = T;
+		static constexpr bool IsAdded = true;
+	};
+	//!@brief クエリの条件: ChangeCursor の前回から変更(追加も含む)された T
+	template <typename T> struct Changed
+	{
+		using Type = T;
+		static constexpr bool IsAdded = false;
+	};
+
+	//!@brief Componentの追加・削除の通知の種類
+	enum class ComponentEvent : std::uint8_t
+	{
+		Added,
+		Removed,
+	};
+	//!@brief EntityManager::addObserver() で登録する通知先
+	using ComponentObserver = std::function<void(Entity&)>;
+	using ObserverID = std::uint32_t;
+
 	using ComponentBitSet = std::bitset<MaxComponents>;
-	using ComponentArray = std::array<ComponentSystem*, MaxComponents>;
+	//ComponentSystem は ComponentSystem* を、データComponentはプールの値のアドレスを入れる
+	using ComponentArray = std::array<void*, MaxComponents>;
 	using GroupBitSet = std::bitset<MaxGroups>;
 
 	class ComponentSystem
 	{
 	private:
-		//EntityɂĎEꂽ̂łȂ
+		//Entityによって殺されたいのでこうなった
 		friend class Entity;
+		friend class Prefab;
+		friend class EntityManager;
 		bool active = true;
+		//同じEntityのComponentの追加・削除を通知してもらうか
+		bool observing = false;
+		std::uint32_t changedTick = 0;
+		ComponentID typeID = 0;
+		std::uint32_t addedTick = 0;
 		void deleteThis() { active = false; }
+	protected:
+		//!@brief 同じEntityにComponentが追加・削除されたら onComponentAdded()/onComponentRemoved() を呼んでもらいます
+		//!@note initialize() の中で呼んでください。通知は EntityManager::refresh() でまとめて行われます
+		void observeSiblings() noexcept;
+		//!@brief [id]が T なら[target]を同じEntityの T に取り直します(なければ nullptr)
+		template <typename T> void rebind(T*& target, ComponentID id) const noexcept;
 	public:
-		Entity * entity;
+		Entity * entity = nullptr;
 		virtual void initialize() = 0;
 		virtual void update() = 0;
 		virtual void draw3D() = 0;
 		virtual void draw2D() = 0;
 		virtual ~ComponentSystem() {}
-		//̃R|[lgĂ邩Ԃ܂
+		//このコンポーネントが生きているか返します
 		virtual bool isActive() const final { return active; }
+		//!@brief 同じEntityに[id]のComponentが追加されたときに呼ばれます(observeSiblings() したものだけ)
+		//!@note 呼ばれる前に同じフレームで削除されていることもあるので、hasComponent() で確認してから取得してください
+		virtual void onComponentAdded(ComponentID /*id*/) {}
+		//!@brief 同じEntityから[id]のComponentが削除されたときに呼ばれます(observeSiblings() したものだけ)
+		//!@note 削除されたComponentはこの後の update() で解放されるので、持っているポインタはここで捨ててください
+		virtual void onComponentRemoved(ComponentID /*id*/) {}
+		//!@brief 値を書き換えたことを記録します(Changed<T> で取り出せるようになります)
+		//!@note 書き換えるメソッドの中か、外から書き換えた後に呼んでください(データComponentは Entity::markChanged<T>())
+		void markChanged() noexcept;
+		//!@brief 最後に markChanged() された(なければ追加された)時刻
+		[[nodiscard]] std::uint32_t getChangedTick() const noexcept { return changedTick; }
+		//!@brief Entityに追加された時刻
+		[[nodiscard]] std::uint32_t getAddedTick() const noexcept { return addedTick; }
+		//Componentはサイズごとのプールから確保します
+		static void* operator new(std::size_t size)
+		{
+			return Memory::PoolAllocator::get().allocate(size);
+		}
+		static void operator delete(void* ptr, std::size_t size) noexcept
+		{
+			Memory::PoolAllocator::get().deallocate(ptr, size);
+		}
 
 	};
 
-	//f[^̓\bhȂ
+	//データはメソッドを持たない
+	//値を直接書き換えたら markChanged() を呼ぶ(Changed<T> で変わったものだけを処理できる)
+	//Note: 新しいデータは ComponentSystem を継承しない構造体にする(ヘッダーなしでプールに詰めて置かれる)
+	//      これは文字列を持つ Screen など、エンジンの中で少数だけ使うもののために残している
 	struct ComponentData : public ComponentSystem
 	{
 		void initialize() override final {}
@@ -73,20 +268,82 @@ namespace ECS
 		void draw3D() override final {}
 	};
 
-	//1ȏ̃R|[lgɂĒ`Entity
+	//!@brief Entity::getComponentAddress() で取ったアドレスを T に戻します
+	template <typename T> T& componentCast(void* address) noexcept
+	{
+		if constexpr (IsDataComponent<T>)
+		{
+			return *static_cast<T*>(address);
+		}
+		else
+		{
+			return static_cast<T&>(*static_cast<ComponentSystem*>(address));
+		}
+	}
+	template <typename T> const T& componentCast(const void* address) noexcept
+	{
+		return componentCast<T>(const_cast<void*>(address));
+	}
+
+	//1つ以上のコンポーネントによって定義されるEntity
 	class Entity final
 	{
 	private:
 		friend class EntityManager;
-		std::string tag;
+		friend class Prefab;
+		friend class ComponentSystem;
+		friend class ComponentSerializer;
+		TagID tag = NoTag;
 		EntityManager& manager_;
+		EntityHandle handle;
 		bool active = true;
-		std::vector<std::unique_ptr<ComponentSystem>> components;
+		//observeSiblings() したComponentがあるか
+		bool siblingObserved = false;
+		std::vector<std::unique_ptr<ComponentSystem>, Memory::PoolStdAllocator<std::unique_ptr<ComponentSystem>>> components;
 		ComponentArray  componentArray;
 		ComponentBitSet componentBitSet;
 		GroupBitSet groupBitSet;
+		//!@brief Componentの確保と解放をMemoryTrackerに記録します
+		void onComponentAllocated(ComponentID id, std::size_t size) noexcept;
+		void onComponentFreed(ComponentID id) noexcept;
+		//!@brief Componentの追加・変更をEntityManagerの型ごとの時刻に記録します
+		void onComponentChanged(ComponentID id, std::uint32_t tick, bool added) noexcept;
+		//!@brief Componentの追加・削除をEntityManagerの通知待ちに積みます
+		void onComponentEvent(ComponentID id, ComponentEvent event);
+		//!@brief 削除したデータComponentを、通知の後に解放するようEntityManagerに渡します
+		void onDataRemoved(ComponentID id);
+		//!@brief データComponentを EntityManager のプールに作ります(EntityManager の後で定義します)
+		template <typename T, typename... TArgs> T& addData(TArgs&&... args);
+		//!@brief observeSiblings() したComponentに[id]の追加・削除を通知します
+		void notifySiblings(ComponentID id, ComponentEvent event)
+		{
+			//通知の中でComponentが追加されることもあるので添字で回す
+			for (std::size_t i = 0; i < components.size(); ++i)
+			{
+				ComponentSystem* c = components[i].get();
+				if (!c->observing || !c->isActive() || c->typeID == id)
+				{
+					continue;
+				}
+				if (event == ComponentEvent::Added)
+				{
+					c->onComponentAdded(id);
+				}
+				else
+				{
+					c->onComponentRemoved(id);
+				}
+			}
+		}
 		void refreshComponent()
 		{
+			for (const auto& c : components)
+			{
+				if (!c->isActive())
+				{
+					onComponentFreed(c->typeID);
+				}
+			}
 			components.erase(std::remove_if(std::begin(components), std::end(components),
 				[](const std::unique_ptr<ComponentSystem> &pCom)
 			{
@@ -94,14 +351,47 @@ namespace ECS
 			}),
 				std::end(components));
 		}
+		//!@brief 確保済みのComponentをこのEntityに登録します(initialize() は呼びません)
+		void attachComponent(ComponentSystem* c, const ComponentID id, const std::size_t size)
+		{
+			c->entity = this;
+			c->typeID = id;
+			c->addedTick = getChangeTick();
+			c->changedTick = c->addedTick;
+			onComponentAllocated(id, size);
+			onComponentChanged(id, c->addedTick, true);
+			onComponentEvent(id, ComponentEvent::Added);
+			components.emplace_back(c);
+			componentArray[id] = c;
+			componentBitSet[id] = true;
+		}
+		//!@brief プールに置いたデータComponentの値をこのEntityに登録します
+		void attachData(void* value, const ComponentID id, const std::size_t size)
+		{
+			onComponentAllocated(id, size);
+			onComponentChanged(id, DataPage::addedTickOf(value), true);
+			onComponentEvent(id, ComponentEvent::Added);
+			componentArray[id] = value;
+			componentBitSet[id] = true;
+		}
 	public:
-		Entity(EntityManager& manager) : manager_(manager) {}
-		//!@brief EntityɂĂComponent̏s܂
+		Entity(EntityManager& manager) : manager_(manager), handle(EntityRegistry::get().add(this)) {}
+		~Entity();
+		//Entityもプールから確保します(弾などを大量に生成してもヒープを呼ばない)
+		static void* operator new(std::size_t size)
+		{
+			return Memory::PoolAllocator::get().allocate(size);
+		}
+		static void operator delete(void* ptr, std::size_t size) noexcept
+		{
+			Memory::PoolAllocator::get().deallocate(ptr, size);
+		}
+		//!@brief このEntityについているComponentの初期化処理を行います
 		void initialize()
 		{
 			for (auto& c : components) c->initialize();
 		}
-		//!@brief EntityɂĂComponent̍XVs܂
+		//!@brief このEntityについているComponentの更新処理を行います
 		void update()
 		{
 			refreshComponent();
@@ -114,12 +404,12 @@ namespace ECS
 				c->update();
 			}
 		}
-		//!@brief EntityɂĂComponent3D`揈s܂
+		//!@brief このEntityについているComponentの3D描画処理を行います
 		void draw3D()
 		{
 			for (auto& c : components) c->draw3D();
 		}
-		//!@brief EntityɂĂComponent2D`揈s܂
+		//!@brief このEntityについているComponentの2D描画処理を行います
 		void draw2D()
 		{
 			for (auto& c : components)
@@ -131,67 +421,100 @@ namespace ECS
 				c->draw2D();
 			}
 		}
-		//!@brief Entity̐Ԃ擾܂
+		//!@brief Entityの生存状態を取得します
 		bool isActive() const { return active; }
-		//!@brief EntityE܂
+		//!@brief Entityを殺します
 		void destroy()
 		{
 			active = false;
 		}
-		//!@brief Entityw肵O[vɓo^Ă邩擾܂
+		//!@brief Entityが指定したグループに登録されているか取得します
 		bool hasGroup(Group group) const noexcept
 		{
 			return groupBitSet[group];
 		}
-		//!@brief EntityO[vɓo^܂
+		//!@brief Entityをグループに登録します
 		void addGroup(Group group) noexcept;
-		//!@brief EntityO[v܂
+		//!@brief Entityをグループから消します
 		void deleteGroup(Group group) noexcept
 		{
 			groupBitSet[group] = false;
 		}
-		//!@brief EntityɎw肵Component邩擾܂
+		//!@brief Entityに指定したComponentがあるか取得します
 		template <typename T> bool hasComponent() const
 		{
 			return componentBitSet[getComponentTypeID<T>()];
 		}
+		//!@brief Entityに型IDで指定したComponentがあるか取得します
+		bool hasComponent(const ComponentID id) const
+		{
+			return componentBitSet[id];
+		}
+		//!@brief 型IDで指定したComponentを取得します(なければnullptr)
+		//!@note データComponentは ComponentSystem ではないので nullptr になります(getComponentAddress() を使ってください)
+		ComponentSystem* getComponent(const ComponentID id) const
+		{
+			if (!hasComponent(id) || isDataComponentType(id))
+			{
+				return nullptr;
+			}
+			return static_cast<ComponentSystem*>(componentArray[id]);
+		}
+		//!@brief 型IDで指定したComponentのアドレスを取得します(なければnullptr)
+		//!@note T に戻すときは componentCast<T>() を使ってください
+		void* getComponentAddress(const ComponentID id) const
+		{
+			return hasComponent(id) ? componentArray[id] : nullptr;
+		}
 
-		//!@brief R|[lg̒ǉ\bh
-		//!@brief ǉꂽR|[lg̏\bhĂ΂܂
+		//!@brief コンポーネントの追加メソッド
+		//!@brief 追加されたらコンポーネントの初期化メソッドが呼ばれます
+		//!@note データComponent(ComponentSystem を継承しない型)は EntityManager のプールに置かれます
 		template <typename T, typename... TArgs> T& addComponent(TArgs&&... args)
 		{
-			//d͋Ȃ
+			//重複は許可しない
 			if (hasComponent<T>())
 			{
 				return getComponent<T>();
 			}
-			//Tips: std::forward
-			//֐ev[g̈]B
-			//̊֐́AnꂽT&&^ɃLXgĕԂBiFTӒlQƂ̏ꍇɂT&&ӒlQƂɂȂAȊȌꍇT&&͉EӒlQƂɂȂBj
-			//̊֐́Aɓ]֐iforwarding functionj̎PړIŎgF
-			T* c(new T(std::forward<TArgs>(args)...));
-			c->entity = this;
-			std::unique_ptr<ComponentSystem> uPtr(c);
-			components.emplace_back(std::move(uPtr));
-
-			componentArray[getComponentTypeID<T>()] = c;
-			componentBitSet[getComponentTypeID<T>()] = true;
+			if constexpr (IsDataComponent<T>)
+			{
+				return addData<T>(std::forward<TArgs>(args)...);
+			}
+			else
+			{
+				//Tips: std::forward
+				//関数テンプレートの引数を転送する。
+				//この関数は、渡された引数をT&&型にキャストして返す。（注：Tが左辺値参照の場合にはT&&も左辺値参照になり、それ以外の場合にT&&は右辺値参照になる。）
+				//この関数は、主に転送関数（forwarding function）の実装を単純化する目的で使われる：
+				T* c(new T(std::forward<TArgs>(args)...));
+				attachComponent(c, getComponentTypeID<T>(), sizeof(T));
 
-			c->initialize();
-			return *c;
+				c->initialize();
+				return *c;
+			}
 		}
 
-		//!@brief w肵R|[lg폜܂
-		template<typename T> void removeComponent() noexcept
+		//!@brief 指定したコンポーネントを削除します
+		template<typename T> void removeComponent()
 		{
 			if (hasComponent<T>())
 			{
-				getComponent<T>().deleteThis();
-				componentBitSet[getComponentTypeID<T>()] = false;
+				const ComponentID id = getComponentTypeID<T>();
+				if constexpr (IsDataComponent<T>)
+				{
+					onDataRemoved(id);
+				}
+				else
+				{
+					getComponent<T>().deleteThis();
+				}
+				componentBitSet[id] = false;
+				onComponentEvent(id, ComponentEvent::Removed);
 			}
 		}
 
-		//!@brief o^R|[lg擾܂
+		//!@brief 登録したコンポーネントを取得します
 		template<typename T> T& getComponent() const
 		{
 			if (!hasComponent<T>())
@@ -200,23 +523,313 @@ namespace ECS
 				assert(hasComponent<T>());
 			}
 			auto ptr(componentArray[getComponentTypeID<T>()]);
-			return *static_cast<T*>(ptr);
+			return componentCast<T>(ptr);
+		}
+		//!@brief [id]のComponentが追加された時刻(なければ 0)
+		std::uint32_t getAddedTick(const ComponentID id) const noexcept
+		{
+			if (!hasComponent(id))
+			{
+				return 0;
+			}
+			return isDataComponentType(id) ? DataPage::addedTickOf(componentArray[id]) : static_cast<const ComponentSystem*>(componentArray[id])->getAddedTick();
+		}
+		//!@brief [id]のComponentが最後に変更(追加も含む)された時刻(なければ 0)
+		std::uint32_t getChangedTick(const ComponentID id) const noexcept
+		{
+			if (!hasComponent(id))
+			{
+				return 0;
+			}
+			return isDataComponentType(id) ? DataPage::changedTickOf(componentArray[id]) : static_cast<const ComponentSystem*>(componentArray[id])->getChangedTick();
+		}
+		template <typename T> std::uint32_t getAddedTick() const noexcept
+		{
+			return getAddedTick(getComponentTypeID<T>());
+		}
+		template <typename T> std::uint32_t getChangedTick() const noexcept
+		{
+			return getChangedTick(getComponentTypeID<T>());
+		}
+		//!@brief T の値を書き換えたことを記録します(Changed<T> で取り出せるようになります)
+		//!@note データComponentは自分では記録できないので、書き換えた側が呼んでください
+		template <typename T> void markChanged() noexcept
+		{
+			markChanged(getComponentTypeID<T>());
+		}
+		//!@brief 型IDで指定したComponentの値を書き換えたことを記録します(ロールバックなど型を知らない書き換え用)
+		void markChanged(const ComponentID id) noexcept
+		{
+			if (!hasComponent(id))
+			{
+				return;
+			}
+			if (isDataComponentType(id))
+			{
+				const std::uint32_t tick = getChangeTick();
+				DataPage::changedTickOf(componentArray[id]) = tick;
+				onComponentChanged(id, tick, false);
+			}
+			else
+			{
+				static_cast<ComponentSystem*>(componentArray[id])->markChanged();
+			}
+		}
+		//!@brief T の値を[args]で作り直し、変更を記録します(データComponentの書き換えはこれを使うと記録漏れがありません)
+		//!@note T がなければ追加します
+		template <typename T, typename... TArgs> T& setComponent(TArgs&&... args)
+		{
+			if (!hasComponent<T>())
+			{
+				return addComponent<T>(std::forward<TArgs>(args)...);
+			}
+			T& component = getComponent<T>();
+			component = T(std::forward<TArgs>(args)...);
+			markChanged<T>();
+			return component;
 		}
-		//!@brief ^OԂ܂
+		//!@brief [cursor]の前回から T が追加されたか
+		template <typename T> bool isAdded(const ChangeCursor& cursor) const
+		{
+			return getAddedTick<T>() > cursor.getSince();
+		}
+		//!@brief [cursor]の前回から T が変更(追加も含む)されたか
+		template <typename T> bool isChanged(const ChangeCursor& cursor) const
+		{
+			return getChangedTick<T>() > cursor.getSince();
+		}
+		//!@brief タグを返します
 		const std::string& getTag() const
+		{
+			return TagRegistry::get().getName(tag);
+		}
+		//!@brief タグの番号を返します
+		TagID getTagID() const noexcept
 		{
 			return tag;
 		}
+		//!@brief イベントなどに入れるためのハンドルを返します
+		[[nodiscard]] EntityHandle getHandle() const noexcept
+		{
+			return handle;
+		}
 	};
 
-	//EntityNX
+	template <typename T> void ComponentSystem::rebind(T*& target, const ComponentID id) const noexcept
+	{
+		if (id == getComponentTypeID<T>())
+		{
+			target = entity->hasComponent<T>() ? &entity->getComponent<T>() : nullptr;
+		}
+	}
+
+	//!@class Prefab
+	//!@brief Entityの原型(Componentの構成と既定値、タグ、グループ)
+	//!@note EntityManager::instantiate() でComponentをコピーコンストラクタで複製し、initialize() をまとめて呼びます
+	//!@note 他のComponentへのポインタは initialize() で取り直すようにしてください
+	//!@note window や renderer などエンジンのComponentは複製しないでください
+	class Prefab final
+	{
+	public:
+		Prefab() = default;
+		Prefab(const Prefab&) = delete;
+		Prefab& operator=(const Prefab&) = delete;
+		//!@brief [entity]の今のComponentとタグ、グループを既定値として取り込みます
+		//!@return false:コピーできないComponentがあった(そのComponentは取り込みません)
+		bool capture(const Entity& entity)
+		{
+			clear();
+			bool result = true;
+			for (const auto& c : entity.components)
+			{
+				if (!c->isActive())
+				{
+					continue;
+				}
+				const CloneFunc clone = getCloneFuncTable()[c->typeID];
+				if (clone == nullptr)
+				{
+					std::cerr << "Prefab: " << typeid(*c).name() << " is not copyable" << std::endl;
+					result = false;
+					continue;
+				}
+				entries.push_back({ c->typeID, std::unique_ptr<ComponentSystem>(clone(*c)), nullptr });
+			}
+			for (ComponentID id = 0; id < MaxComponents; ++id)
+			{
+				if (entity.componentBitSet[id] && isDataComponentType(id))
+				{
+					entries.push_back({ id, nullptr, getDataComponentOpsTable()[id]->copy(entity.componentArray[id]) });
+				}
+			}
+			tag = entity.tag;
+			groups = entity.groupBitSet;
+			return result;
+		}
+		//!@brief [T]を[args]で作り、既定値として追加します(同じ型があれば置き換えます)
+		//!@note ここでは initialize() は呼ばれません
+		template <typename T, typename... TArgs> Prefab& add(TArgs&&... args)
+		{
+			static_assert(std::is_copy_constructible_v<T>, "Prefab component must be copy constructible");
+			Entry added = { getComponentTypeID<T>(), nullptr, nullptr };
+			if constexpr (IsDataComponent<T>)
+			{
+				added.data = std::make_shared<T>(std::forward<TArgs>(args)...);
+			}
+			else
+			{
+				added.prototype.reset(new T(std::forward<TArgs>(args)...));
+				added.prototype->entity = nullptr;
+			}
+			for (auto& entry : entries)
+			{
+				if (entry.id == added.id)
+				{
+					entry = std::move(added);
+					return *this;
+				}
+			}
+			entries.push_back(std::move(added));
+			return *this;
+		}
+		//!@brief 作るEntityのタグを設定します
+		Prefab& setTag(const std::string& name)
+		{
+			tag = TagRegistry::get().intern(name);
+			return *this;
+		}
+		//!@brief 作るEntityを[group]に登録します
+		Prefab& addGroup(const Group group) noexcept
+		{
+			groups[group] = true;
+			return *this;
+		}
+		//!@brief 空にします
+		void clear() noexcept
+		{
+			entries.clear();
+			tag = NoTag;
+			groups.reset();
+		}
+		//!@brief Componentの数
+		[[nodiscard]] std::size_t getComponentNum() const noexcept
+		{
+			return entries.size();
+		}
+	private:
+		friend class EntityManager;
+		//ComponentSystem は prototype に、データComponentは data に既定値を持つ
+		struct Entry
+		{
+			ComponentID id;
+			std::unique_ptr<ComponentSystem> prototype;
+			std::shared_ptr<void> data;
+		};
+		std::vector<Entry> entries;
+		TagID tag = NoTag;
+		GroupBitSet groups;
+	};
+
+	//Entity統括クラス
 	class EntityManager final
 	{
 	private:
+		//Entityの解放時にも記録するので、entityesより先に宣言する
+		Memory::MemoryCounter memoryCounter;
+		Telemetry::PhaseCounter phaseCounter;
+		//型ごとの最後の追加・変更の時刻(何も変わっていない型はEntityを走査しない)
+		std::array<std::atomic<std::uint32_t>, MaxComponents> addedTicks{};
+		std::array<std::atomic<std::uint32_t>, MaxComponents> changedTicks{};
+		//データComponentの型ごとのプール(Entityの解放時に値を返すので、entityesより先に宣言する)
+		std::array<std::unique_ptr<DataPoolBase>, MaxComponents> dataPools;
+		//削除されたデータComponent(通知の後に解放する)
+		struct RemovedData
+		{
+			Entity* entity;
+			ComponentID type;
+			void* value;
+		};
+		std::vector<RemovedData> removedData;
 		std::vector<std::unique_ptr<Entity>> entityes;
 		std::array<std::vector<Entity*>, MaxGroups> groupedEntities;
+		//タグごとのEntity(追加した順)
+		std::unordered_map<TagID, std::vector<Entity*>> taggedEntities;
+		std::vector<TagID> removedTags;
+		//Componentの追加・削除の通知先と、refresh() まで溜めておく通知
+		struct ObserverEntry
+		{
+			ObserverID id;
+			ComponentID type;
+			ComponentEvent event;
+			ComponentObserver func;
+		};
+		struct PendingEvent
+		{
+			Entity* entity;
+			ComponentID type;
+			ComponentEvent event;
+		};
+		std::vector<ObserverEntry> observers;
+		ComponentBitSet observedTypes;
+		ObserverID nextObserverID = 0;
+		std::vector<PendingEvent> pendingEvents;
+		std::vector<PendingEvent> dispatchingEvents;
+		//!@brief 溜まっている通知を送ります
+		//!@note 通知の中で追加・削除されたものも続けて送ります(循環しても止まるように回数は制限します)
+		void flushComponentEvents()
+		{
+			constexpr int MaxPass = 8;
+			for (int pass = 0; pass < MaxPass && !pendingEvents.empty(); ++pass)
+			{
+				dispatchingEvents.swap(pendingEvents);
+				for (const auto& ev : dispatchingEvents)
+				{
+					Entity& e = *ev.entity;
+					if (e.siblingObserved && e.isActive())
+					{
+						e.notifySiblings(ev.type, ev.event);
+					}
+					if (!observedTypes[ev.type])
+					{
+						continue;
+					}
+					//通知の中で addObserver() されることもあるので添字で回す
+					for (std::size_t i = 0; i < observers.size(); ++i)
+					{
+						if (observers[i].type == ev.type && observers[i].event == ev.event)
+						{
+							observers[i].func(e);
+						}
+					}
+				}
+				dispatchingEvents.clear();
+			}
+		}
+		//!@brief [tick]が[target]より新しければ更新します(時刻が戻らないように)
+		static void raiseTick(std::atomic<std::uint32_t>& target, const std::uint32_t tick) noexcept
+		{
+			std::uint32_t current = target.load(std::memory_order_relaxed);
+			while (current < tick && !target.compare_exchange_weak(current, tick, std::memory_order_relaxed)) {}
+		}
+		//!@brief 削除されたデータComponentをプールに返します
+		void freeRemovedData()
+		{
+			for (const auto& removed : removedData)
+			{
+				dataPools[removed.type]->free(removed.value);
+				removed.entity->onComponentFreed(removed.type);
+			}
+			removedData.clear();
+		}
 	public:
-		//!@brief s܂
+		EntityManager() = default;
+		EntityManager(const EntityManager&) = delete;
+		EntityManager& operator=(const EntityManager&) = delete;
+		~EntityManager()
+		{
+			freeRemovedData();
+		}
+		//!@brief 初期化を行います
 		void initialize()
 		{
 			for (auto& e : entityes)
@@ -224,7 +837,7 @@ namespace ECS
 				e->initialize();
 			}
 		}
-		//!@brief XVs܂
+		//!@brief 更新を行います
 		void update()
 		{
 			for (auto& e : entityes)
@@ -236,7 +849,7 @@ namespace ECS
 				e->update();
 			}
 		}
-		//!@brief 3D̕`s܂
+		//!@brief 3Dの描画を行います
 		void draw3D()
 		{
 			for (auto& e : entityes)
@@ -244,7 +857,7 @@ namespace ECS
 				e->draw3D();
 			}
 		}
-		//!@brief O[vƂ̕`o^ɍs
+		//!@brief グループごとの描画を登録順に行う
 		void orderByDraw(const size_t TheMaximumNumberOfRegistered)
 		{
 			for (auto i(0u); i < TheMaximumNumberOfRegistered; ++i)
@@ -256,7 +869,7 @@ namespace ECS
 				}
 			}
 		}
-		//!@brief 2D̕`s܂
+		//!@brief 2Dの描画を行います
 		void draw2D()
 		{
 			for (auto& e : entityes)
@@ -264,7 +877,7 @@ namespace ECS
 				e->draw2D();
 			}
 		}
-		//!@brief ׂĂEntityKill܂
+		//!@brief すべてのEntityをKillします
 		void allKill()
 		{
 			for (auto& e : entityes)
@@ -272,9 +885,29 @@ namespace ECS
 				e->destroy();
 			}
 		}
-		//!@brief ANeBułȂ̂폜܂
+		//!@brief 溜まっているComponentの追加・削除を通知し、アクティブでないものを削除します
 		void refresh()
 		{
+			//殺されたEntityのComponentは、解放する前に削除として通知する
+			if (observedTypes.any())
+			{
+				for (const auto& e : entityes)
+				{
+					if (e->isActive())
+					{
+						continue;
+					}
+					for (ComponentID id = 0; id < MaxComponents; ++id)
+					{
+						if (e->componentBitSet[id] && observedTypes[id])
+						{
+							pendingEvents.push_back({ e.get(), id, ComponentEvent::Removed });
+						}
+					}
+				}
+			}
+			flushComponentEvents();
+			freeRemovedData();
 			for (auto i(0u); i < MaxGroups; ++i)
 			{
 				auto& v(groupedEntities[i]);
@@ -288,63 +921,308 @@ namespace ECS
 					std::end(v));
 			}
 
+			removedTags.clear();
+			std::size_t componentNum = 0;
+			for (const auto& e : entityes)
+			{
+				if (e->isActive())
+				{
+					componentNum += e->componentBitSet.count();
+				}
+				else
+				{
+					Event::EventBus::get().publish(Event::EntityDestroyedEvent{ e->handle });
+					if (e->tag != NoTag)
+					{
+						removedTags.emplace_back(e->tag);
+					}
+				}
+			}
+			std::sort(removedTags.begin(), removedTags.end());
+			removedTags.erase(std::unique(removedTags.begin(), removedTags.end()), removedTags.end());
+			for (const TagID tag : removedTags)
+			{
+				auto& v = taggedEntities[tag];
+				v.erase(std::remove_if(std::begin(v), std::end(v),
+					[](Entity* pEntity)
+				{
+					return !pEntity->isActive();
+				}),
+					std::end(v));
+				if (v.empty())
+				{
+					taggedEntities.erase(tag);
+				}
+			}
 			entityes.erase(std::remove_if(std::begin(entityes), std::end(entityes),
 				[](const std::unique_ptr<Entity> &pEntity)
 			{
 				return !pEntity->isActive();
 			}),
 				std::end(entityes));
+			phaseCounter.setCount(entityes.size(), componentNum);
+		}
+		//!@brief 登録されているすべてのEntityを取得します
+		const std::vector<std::unique_ptr<Entity>>& getEntities() const noexcept
+		{
+			return entityes;
 		}
-		//!@brief w肵O[vɓo^ĂEntityB擾܂
+		//!@brief [count]個分のEntityを追加できるように先に確保しておきます
+		void reserve(const std::size_t count)
+		{
+			entityes.reserve(entityes.size() + count);
+			Memory::PoolAllocator::get().reserve(sizeof(Entity), count);
+		}
+		//!@brief 指定したグループに登録されているEntity達を取得します
 		std::vector<Entity*>& getEntitiesByGroup(Group group)
 		{
 			return groupedEntities[group];
 		}
-		//!@brief Entityw肵O[vɓo^܂
+		//!@brief Entityを指定したグループに登録します
 		void addToGroup(Entity* pEntity, Group group)
 		{
 			groupedEntities[group].emplace_back(pEntity);
 		}
-		//!@brief Entity𐶐̃|C^Ԃ
-		//!@brief ^Oݒ肵ĂƃfobOƂɒǂ₷
+		//!@brief このEntityManagerが使っているメモリのカウンタを取得します
+		[[nodiscard]] Memory::MemoryCounter& getMemoryCounter() noexcept
+		{
+			return memoryCounter;
+		}
+		//!@brief [id]の型が追加・変更されたことを記録します
+		void onComponentChanged(const ComponentID id, const std::uint32_t tick, const bool added) noexcept
+		{
+			raiseTick(changedTicks[id], tick);
+			if (added)
+			{
+				raiseTick(addedTicks[id], tick);
+			}
+		}
+		//!@brief データComponent T のプールを取得します
+		template <typename T> DataPool<T>& getDataPool()
+		{
+			static_assert(IsDataComponent<T>, "ComponentSystem is not stored in DataPool");
+			return static_cast<DataPool<T>&>(getDataPool(getComponentTypeID<T>()));
+		}
+		//!@brief 型IDで指定したデータComponentのプールを取得します(初めてなら作ります)
+		DataPoolBase& getDataPool(const ComponentID id)
+		{
+			if (dataPools[id] == nullptr)
+			{
+				dataPools[id].reset(getDataComponentOpsTable()[id]->createPool());
+			}
+			return *dataPools[id];
+		}
+		//!@brief データComponent T を持つEntityすべてに[func](Entity&, T&)を呼びます
+		//!@note 値はページごとに詰めて並んでいるので、Entityを1つずつ hasComponent() で調べるより速く回せます
+		template <typename T, typename Func> void each(Func&& func)
+		{
+			getDataPool<T>().forEach(std::forward<Func>(func));
+		}
+		//!@brief [entity]から削除された[type]のデータComponentを、次の refresh() の通知の後に解放します
+		void onDataRemoved(Entity& entity, const ComponentID type, void* value)
+		{
+			dataPools[type]->detach(value);
+			removedData.push_back({ &entity, type, value });
+		}
+		//!@brief [T]が[event](追加・削除)されたときに[observer]を呼びます
+		//!@note 通知は refresh() でまとめて、起きた順に行われます(呼ばれるのは update() の前)
+		//!@return removeObserver() に渡す番号
+		template <typename T> ObserverID addObserver(const ComponentEvent event, ComponentObserver observer)
+		{
+			const ComponentID type = getComponentTypeID<T>();
+			observers.push_back({ nextObserverID, type, event, std::move(observer) });
+			observedTypes[type] = true;
+			return nextObserverID++;
+		}
+		//!@brief addObserver() で登録したものを削除します
+		void removeObserver(const ObserverID id)
+		{
+			observers.erase(std::remove_if(observers.begin(), observers.end(),
+				[id](const ObserverEntry& o) { return o.id == id; }), observers.end());
+			observedTypes.reset();
+			for (const auto& o : observers)
+			{
+				observedTypes[o.type] = true;
+			}
+		}
+		//!@brief [entity]の[type]の追加・削除を通知待ちに積みます(通知先がなければ何もしません)
+		void queueComponentEvent(Entity& entity, const ComponentID type, const ComponentEvent event)
+		{
+			if (entity.siblingObserved || observedTypes[type])
+			{
+				pendingEvents.push_back({ &entity, type, event });
+			}
+		}
+		//!@brief [id]の型が最後に追加された時刻
+		[[nodiscard]] std::uint32_t getAddedTick(const ComponentID id) const noexcept
+		{
+			return addedTicks[id].load(std::memory_order_relaxed);
+		}
+		//!@brief [id]の型が最後に変更(追加も含む)された時刻
+		[[nodiscard]] std::uint32_t getChangedTick(const ComponentID id) const noexcept
+		{
+			return changedTicks[id].load(std::memory_order_relaxed);
+		}
+		//!@brief [cursor]の前回から Filter(Added<T> / Changed<T>)に当てはまるEntityを[out]に追加します
+		//!@note 型ごとの時刻を先に見るので、その型が何も変わっていなければEntityを走査しません
+		template <typename Filter> void collect(const ChangeCursor& cursor, std::vector<Entity*>& out) const
+		{
+			const ComponentID id = getComponentTypeID<typename Filter::Type>();
+			const std::uint32_t since = cursor.getSince();
+			if ((Filter::IsAdded ? getAddedTick(id) : getChangedTick(id)) <= since)
+			{
+				return;
+			}
+			for (const auto& e : entityes)
+			{
+				if (!e->isActive() || !e->hasComponent(id))
+				{
+					continue;
+				}
+				if ((Filter::IsAdded ? e->getAddedTick(id) : e->getChangedTick(id)) > since)
+				{
+					out.emplace_back(e.get());
+				}
+			}
+		}
+		//!@brief このEntityManagerの処理時間のカウンタを取得します
+		[[nodiscard]] Telemetry::PhaseCounter& getPhaseCounter() noexcept
+		{
+			return phaseCounter;
+		}
+		//!@brief Entityを生成しそのポインタを返す
+		//!@brief タグを設定しておくとデバッグするときに追いかけやすい
 		Entity& addEntityAddTag(const std::string& tag)
 		{
-			Entity* e = new Entity(*this);
-			std::unique_ptr<Entity> uPtr(e);
-			entityes.emplace_back(std::move(uPtr));
-			entityes.back()->tag = tag;
-			return *e;
+			Entity& e = addEntity();
+			e.tag = TagRegistry::get().intern(tag);
+			if (e.tag != NoTag)
+			{
+				taggedEntities[e.tag].emplace_back(&e);
+			}
+			return e;
 		}
-		//!@brief Entity𐶐̃|C^Ԃ
-		//!@brief {Iɂg
+		//!@brief Entityを生成しそのポインタを返す
+		//!@brief 基本的にこちらを使う
 		Entity& addEntity()
 		{
 			Entity* e = new Entity(*this);
+			memoryCounter.onAllocate(sizeof(Entity));
 			std::unique_ptr<Entity> uPtr(e);
 			entityes.emplace_back(std::move(uPtr));
-			entityes.back()->tag = "";
 			return *e;
 		}
-		//^Ow肵Entity擾
-		//sꍇ
-		//Entity& GetEntity(const std::string& tag)
-		//{
-		//	constexpr bool  NOT_FOUND_TAG = false;
-		//	assert(!(tag == ""));
-		//	for (const auto& it : entityes)
-		//	{
-		//		if (it->tag == tag)
-		//		{
-		//			return *it;
-		//		}
-		//	}
-		//	//擾Ɏsꍇ͂Ƃ肠Ƃ
-		//	assert(NOT_FOUND_TAG);
-		//	return *entityes[0];
-		//}
+		//!@brief [prefab]から[count]個のEntityを作り、[out]の後ろに追加します
+		//!@brief Entityと各Componentのメモリは先にまとめて確保し、initialize() はComponentの種類ごとにまとめて呼びます
+		void instantiate(const Prefab& prefab, const std::size_t count, std::vector<Entity*>& out)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+			auto& tracker = Memory::MemoryTracker::get();
+			const auto& cloneFuncTable = getCloneFuncTable();
+			reserve(count);
+			//initialize() を呼ぶのは ComponentSystem だけ(Entityの components に Prefab と同じ順で入る)
+			std::size_t systemNum = 0;
+			for (const auto& entry : prefab.entries)
+			{
+				if (entry.prototype != nullptr)
+				{
+					Memory::PoolAllocator::get().reserve(tracker.getTypeSize(entry.id), count);
+					++systemNum;
+				}
+			}
+			std::array<Group, MaxGroups> groups;
+			std::size_t groupNum = 0;
+			for (Group g = 0; g < MaxGroups; ++g)
+			{
+				if (prefab.groups[g])
+				{
+					groups[groupNum++] = g;
+					groupedEntities[g].reserve(groupedEntities[g].size() + count);
+				}
+			}
+			out.reserve(out.size() + count);
+			//キャッシュに乗る数ずつ作って、その中で initialize() をComponentの種類ごとにまとめて呼ぶ
+			//Entityの中の順番は保つので、前のComponentに依存する initialize() もそのまま動く
+			constexpr std::size_t BlockSize = 64;
+			for (std::size_t blockBegin = 0; blockBegin < count; blockBegin += BlockSize)
+			{
+				const std::size_t first = out.size();
+				const std::size_t blockEnd = std::min(blockBegin + BlockSize, count);
+				for (std::size_t i = blockBegin; i < blockEnd; ++i)
+				{
+					Entity& e = addEntity();
+					e.components.reserve(systemNum);
+					for (const auto& entry : prefab.entries)
+					{
+						if (entry.data != nullptr)
+						{
+							e.attachData(getDataPool(entry.id).clone(e, getChangeTick(), entry.data.get()), entry.id, tracker.getTypeSize(entry.id));
+							continue;
+						}
+						e.attachComponent(cloneFuncTable[entry.id](*entry.prototype), entry.id, tracker.getTypeSize(entry.id));
+					}
+					e.tag = prefab.tag;
+					if (e.tag != NoTag)
+					{
+						taggedEntities[e.tag].emplace_back(&e);
+					}
+					for (std::size_t g = 0; g < groupNum; ++g)
+					{
+						e.addGroup(groups[g]);
+					}
+					out.emplace_back(&e);
+				}
+				for (std::size_t c = 0; c < systemNum; ++c)
+				{
+					for (std::size_t i = first; i < out.size(); ++i)
+					{
+						out[i]->components[c]->initialize();
+					}
+				}
+			}
+		}
+		//!@brief [prefab]から[count]個のEntityを作ります
+		std::vector<Entity*> instantiate(const Prefab& prefab, const std::size_t count)
+		{
+			std::vector<Entity*> out;
+			instantiate(prefab, count, out);
+			return out;
+		}
+		//!@brief タグを指定しそのEntityを取得する(同じタグが複数あれば最初に追加したもの)
+		//!@return 見つからなければ nullptr
+		[[nodiscard]] Entity* getEntityByTag(const TagID tag) const
+		{
+			const auto itr = taggedEntities.find(tag);
+			return itr == taggedEntities.end() ? nullptr : itr->second.front();
+		}
+		[[nodiscard]] Entity* getEntityByTag(const std::string& tag) const
+		{
+			return getEntityByTag(TagRegistry::get().find(tag));
+		}
+		//!@brief タグを指定しそのEntity達を取得する(追加した順)
+		[[nodiscard]] const std::vector<Entity*>& getEntitiesByTag(const TagID tag) const
+		{
+			static const std::vector<Entity*> empty;
+			const auto itr = taggedEntities.find(tag);
+			return itr == taggedEntities.end() ? empty : itr->second;
+		}
+		[[nodiscard]] const std::vector<Entity*>& getEntitiesByTag(const std::string& tag) const
+		{
+			return getEntitiesByTag(TagRegistry::get().find(tag));
+		}
 	};
 
-	//!@class Entity̌^邽߂̃C^[tF[X
+	template <typename T, typename... TArgs> T& Entity::addData(TArgs&&... args)
+	{
+		T* value = manager_.getDataPool<T>().emplace(*this, getChangeTick(), std::forward<TArgs>(args)...);
+		attachData(value, getComponentTypeID<T>(), sizeof(T));
+		return *value;
+	}
+
+	//!@class Entityの原型を作るためのインターフェース
 	template<class... Args>
 	class IArcheType
 	{
@@ -353,36 +1231,93 @@ namespace ECS
 	};
 
 	//!@class EntitySystemManager
-	//!@brief EntityManagerǗVXe
+	//!@brief EntityManagerを管理するシステム
+	//!@note EntityManager(ワールド)は登録した順に更新します。addDependency() で依存を宣言すると
+	//!@note 依存し合っていないワールドの refresh/update はジョブシステムで並列に行います
+	//!@note draw2D/draw3D は常に更新順に1つずつ行います(ヘッドレスでは行いません)
+	//!@note 並列に更新されるワールドが触っても良いシングルトンは、ロックを取る DrawScene・TextureCache(TextureHandle)・
+	//!@note EventBus の発行・TagRegistry・MemoryTracker・FrameTelemetry・PoolAllocator・JobSystem だけです
+	//!@note Runtime は読むだけにし、RendererSystem のコマンドリストや SDL の呼び出し、FrameAllocator は draw2D/draw3D など1つずつ行う処理から使ってください
+	//!@note refresh/update はメインスレッドで前のフレームを描画している間にワーカーで行います(Job::MainThread::runWhile())
+	//!@note update から SDL を触るときは RendererSystem::invoke() でメインスレッドに頼んでください
 	class EntitySystemManager final
 	{
 		class Singleton final
 		{
+		public:
+			//起動直後はアセットの読み込みやリストの伸長で確保が起きるので、このフレーム数までは調べない
+			static constexpr std::uint64_t DefaultAllocationWarmupFrames = 120;
 		public:
 			virtual ~Singleton() noexcept final
 			{
+				//依存されている側が後に解放されるように、更新順の逆に解放する
+				buildSchedule();
+				for (auto itr = sortedNames.rbegin(); itr != sortedNames.rend(); ++itr)
+				{
+					manager.erase(*itr);
+				}
 				manager.clear();
 			}
-			//!@brief EntityManagero^܂
+			//!@brief EntityManagerを登録します
 			[[noreturn]] void regist(const std::string& name, std::unique_ptr<ECS::EntityManager>& entityManager) noexcept
 			{
+				if (manager.find(name) == manager.end())
+				{
+					order.emplace_back(name);
+				}
 				manager[name] = std::move(entityManager);
+				Memory::MemoryTracker::get().registCounter(name, manager[name]->getMemoryCounter());
+				Telemetry::FrameTelemetry::get().registCounter(name, manager[name]->getPhaseCounter());
+				scheduleDirty = true;
 			}
-			//!@brief EntityManager폜܂
+			//!@brief EntityManagerを削除します
 			[[noreturn]] void remove(const std::string& name) noexcept
 			{
 				const auto& itr = manager.find(name);
 				if (itr != manager.end())
 				{
+					Memory::MemoryTracker::get().removeCounter(name);
+					Telemetry::FrameTelemetry::get().removeCounter(name);
 					manager.erase(itr);
+					order.erase(std::remove(order.begin(), order.end(), name), order.end());
+					dependencies.erase(name);
+					scheduleDirty = true;
+				}
+			}
+			//!@brief [name]が[dependsOn]のデータを使うことを宣言します
+			//!@brief [name]は[dependsOn]の更新が終わってから更新されます
+			void addDependency(const std::string& name, const std::string& dependsOn)
+			{
+				auto& list = dependencies[name];
+				if (std::find(list.begin(), list.end(), dependsOn) == list.end())
+				{
+					list.emplace_back(dependsOn);
 				}
+				scheduleDirty = true;
+			}
+			//!@brief 定常状態のヒープ確保を調べ始めるまでのフレーム数を設定します(0 なら調べません)
+			//!@note デバッグビルドで VOLKA_ENABLE_ALLOCATION_HOOK を定義したときだけ調べます
+			void setAllocationWarmupFrames(const std::uint64_t frames) noexcept
+			{
+				allocationWarmupFrames = frames;
+			}
+			//!@brief 依存し合っていないワールドを並列に更新するか設定します
+			void setParallel(const bool enable) noexcept
+			{
+				parallel = enable;
 			}
-			//!@brief EntityManager擾܂
+			//!@brief 更新する順番(EntityManagerの名前)を取得します
+			[[nodiscard]] const std::vector<std::string>& getUpdateOrder()
+			{
+				buildSchedule();
+				return sortedNames;
+			}
+			//!@brief EntityManagerを取得します
 			[[nodiscard]] ECS::EntityManager& getEntityManager(const std::string& name) const noexcept
 			{
 				return *manager.at(name).get();
 			}
-			//!@brief EntityManager邩mF
+			//!@brief EntityManagerがあるか確認する
 			[[nodiscard]] const bool hasEntityManager(const std::string& name) const noexcept
 			{
 				const auto& itr = manager.find(name);
@@ -394,23 +1329,174 @@ namespace ECS
 			}
 			[[noreturn]] void initialize() noexcept
 			{
-				for (const auto& m : manager)
+				buildSchedule();
+				for (const auto& level : levels)
+				{
+					for (auto* m : level)
+					{
+						m->initialize();
+					}
+				}
+			}
+			void update() noexcept
+			{
+				//前のフレームの一時データを捨てて、アロケーションの計測を区切る
+				Memory::FrameAllocator::get().beginFrame();
+				Memory::AllocationHook::beginFrame();
+#ifdef _DEBUG
+				checkSteadyAllocation();
+#endif
+				Memory::MemoryTracker::get().beginFrame();
+				Telemetry::FrameTelemetry::get().beginFrame();
+				Runtime::get().advance();
+				//前のフレームに発行されたイベントを読めるようにし、subscribe() した関数に配る
+				Event::EventBus::get().swap();
+				Event::EventBus::get().dispatch();
+				buildSchedule();
+				//SDL の描画は SDL_Renderer を作ったメインスレッドに残し、前のフレームの描画と重ねてワーカーで更新する
+				Job::MainThread::get().runWhile([this]() { updateLevels(); });
+				//ヘッドレスは描画しないので、更新だけを固定の時間刻みで回す
+				if (Runtime::get().isHeadless())
+				{
+					return;
+				}
+				for (const auto& level : levels)
+				{
+					for (auto* m : level)
+					{
+						Telemetry::ScopedPhase scope(m->getPhaseCounter(), Telemetry::Phase::Draw2D);
+						m->draw2D();
+					}
+				}
+				for (const auto& level : levels)
+				{
+					for (auto* m : level)
+					{
+						Telemetry::ScopedPhase scope(m->getPhaseCounter(), Telemetry::Phase::Draw3D);
+						m->draw3D();
+					}
+				}
+			}
+		private:
+			//!@brief 更新の段ごとに refresh と update を行います
+			//!@brief 同じ段のワールドは依存し合っていないので並列に更新し、段の間でだけ待つ
+			void updateLevels()
+			{
+				for (const auto& level : levels)
+				{
+					if (!parallel || level.size() == 1)
+					{
+						for (auto* m : level)
+						{
+							refreshAndUpdate(*m);
+						}
+						continue;
+					}
+					auto& jobSystem = Job::JobSystem::get();
+					Job::JobCounter counter;
+					for (std::size_t i = 1; i < level.size(); ++i)
+					{
+						ECS::EntityManager* m = level[i];
+						jobSystem.submit(counter, [m]()
+						{
+							refreshAndUpdate(*m);
+						});
+					}
+					refreshAndUpdate(*level[0]);
+					jobSystem.wait(counter);
+				}
+			}
+			//!@brief [m]の refresh と update を、それぞれの時間を計りながら行います
+			static void refreshAndUpdate(ECS::EntityManager& m)
+			{
 				{
-					m.second.get()->initialize();
+					Telemetry::ScopedPhase scope(m.getPhaseCounter(), Telemetry::Phase::Refresh);
+					m.refresh();
 				}
+				Telemetry::ScopedPhase scope(m.getPhaseCounter(), Telemetry::Phase::Update);
+				m.update();
 			}
-			[[noreturn]] void update() noexcept
+			//!@brief 起動直後を過ぎても前のフレームでヒープ確保があれば知らせます
+			//!@note VOLKA_ENABLE_ALLOCATION_HOOK を定義したときだけ数えられます
+			void checkSteadyAllocation() const
 			{
-				for (const auto& m : manager)
+				if (!Memory::AllocationHook::isEnabled() || allocationWarmupFrames == 0 ||
+					Memory::FrameAllocator::get().getFrameCount() <= allocationWarmupFrames)
+				{
+					return;
+				}
+				const std::size_t count = Memory::AllocationHook::getLastFrameCount();
+				if (count > 0)
+				{
+					std::cerr << "EntitySystemManager: " << count << " heap allocations in a steady-state frame" << std::endl;
+				}
+			}
+			//!@brief 依存関係から更新の段を作ります(同じ段の中は登録順)
+			void buildSchedule()
+			{
+				if (!scheduleDirty)
+				{
+					return;
+				}
+				scheduleDirty = false;
+				levels.clear();
+				sortedNames.clear();
+				std::vector<std::string> remaining = order;
+				std::vector<std::string> placed;
+				while (!remaining.empty())
 				{
-					m.second.get()->refresh();
-					m.second.get()->update();
-					m.second.get()->draw2D();
-					m.second.get()->draw3D();
+					std::vector<std::string> level;
+					for (const auto& name : remaining)
+					{
+						bool ready = true;
+						const auto itr = dependencies.find(name);
+						if (itr != dependencies.end())
+						{
+							for (const auto& dependsOn : itr->second)
+							{
+								if (manager.find(dependsOn) != manager.end() &&
+									std::find(placed.begin(), placed.end(), dependsOn) == placed.end())
+								{
+									ready = false;
+									break;
+								}
+							}
+						}
+						if (ready)
+						{
+							level.emplace_back(name);
+						}
+					}
+					if (level.empty())
+					{
+						//循環しているので、残りは登録順に1つずつ更新する
+						std::cerr << "EntitySystemManager: circular dependency between worlds" << std::endl;
+						for (const auto& name : remaining)
+						{
+							levels.push_back({ manager.at(name).get() });
+							sortedNames.emplace_back(name);
+						}
+						break;
+					}
+					levels.emplace_back();
+					for (const auto& name : level)
+					{
+						levels.back().emplace_back(manager.at(name).get());
+						sortedNames.emplace_back(name);
+						placed.emplace_back(name);
+						remaining.erase(std::find(remaining.begin(), remaining.end(), name));
+					}
 				}
 			}
 		private:
 			std::unordered_map<std::string, std::unique_ptr<ECS::EntityManager>> manager;
+			std::vector<std::string> order;
+			std::unordered_map<std::string, std::vector<std::string>> dependencies;
+			std::vector<std::vector<ECS::EntityManager*>> levels;
+			std::vector<std::string> sortedNames;
+			bool scheduleDirty = true;
+			bool parallel = true;
+			std::uint64_t allocationWarmupFrames = DefaultAllocationWarmupFrames;
 		};
 	public:
 		[[nodiscard]] inline static Singleton& get() noexcept
@@ -0,0 +1,98 @@
+//---------------------------------------------------------
+//!@file EntityHandle.hpp
+//!@brief Entityを番号と世代で指す EntityHandle と、それを引く EntityRegistry を用意します
+//!@author Volka
+//!@date 2018/11/3
+//!@note 番号は Entity の解放後に使い回しますが、そのたびに世代が進むので古いハンドルは引けなくなります
+//!@note イベントなど、Entityより長く残るかもしれないところにはポインタではなくこれを入れます
+//---------------------------------------------------------
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ECS
+{
+	class Entity;
+
+	//!@class EntityHandle
+	struct EntityHandle
+	{
+		static constexpr std::uint32_t InvalidIndex = UINT32_MAX;
+		std::uint32_t index = InvalidIndex;
+		std::uint32_t generation = 0;
+
+		[[nodiscard]] bool operator==(const EntityHandle& other) const noexcept
+		{
+			return index == other.index && generation == other.generation;
+		}
+		[[nodiscard]] bool operator!=(const EntityHandle& other) const noexcept
+		{
+			return !(*this == other);
+		}
+	};
+
+	//!@class EntityRegistry
+	//!@brief 生きている Entity をハンドルから引けるようにします
+	//!@note Entity の生成と解放で登録・解除されます(並列に更新されるワールドからも呼ばれるのでロックを取ります)
+	class EntityRegistry final
+	{
+	public:
+		//!@brief [entity]を登録してハンドルを返します
+		[[nodiscard]] EntityHandle add(Entity* entity)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			std::uint32_t index;
+			if (!freeIndices.empty())
+			{
+				index = freeIndices.back();
+				freeIndices.pop_back();
+			}
+			else
+			{
+				index = static_cast<std::uint32_t>(slots.size());
+				slots.emplace_back();
+			}
+			slots[index].entity = entity;
+			return EntityHandle{ index, slots[index].generation };
+		}
+		//!@brief [handle]の登録を解除します(世代が進むので、残っているハンドルは引けなくなります)
+		void remove(const EntityHandle& handle)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation)
+			{
+				return;
+			}
+			slots[handle.index].entity = nullptr;
+			++slots[handle.index].generation;
+			freeIndices.emplace_back(handle.index);
+		}
+		//!@brief [handle]の Entity を取得します
+		//!@return 解放済みなら nullptr
+		[[nodiscard]] Entity* find(const EntityHandle& handle) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation)
+			{
+				return nullptr;
+			}
+			return slots[handle.index].entity;
+		}
+		//!@brief 終了時に EntityManager の破棄が後になっても使えるように、意図的に解放しません
+		[[nodiscard]] static EntityRegistry& get() noexcept
+		{
+			static EntityRegistry* entityRegistry = new EntityRegistry();
+			return *entityRegistry;
+		}
+	private:
+		struct Slot
+		{
+			Entity* entity = nullptr;
+			std::uint32_t generation = 0;
+		};
+		std::vector<Slot> slots;
+		std::vector<std::uint32_t> freeIndices;
+		mutable std::mutex mutex;
+	};
+}
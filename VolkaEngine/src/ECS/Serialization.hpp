@@ -0,0 +1,560 @@
+//---------------------------------------------------------
+//!@file Serialization.hpp
+//!@brief Entity/シーンをバイナリで保存・読み込みします
+//!@author Volka
+//!@date 2018/11/3
+//!@note Componentは登録したメンバだけを固定長のペイロードとして扱います
+//!@note ファイルは型テーブル + Entityごとのグループとタグ名 + 型ごとの列(Entity番号の配列 + ペイロードの配列)です
+//!@note 読み込みはファイルをマップし、すべての列を確かめてから、型ごとの列をまとめてコピーします
+//---------------------------------------------------------
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <type_traits>
+#include "ECS.hpp"
+#include "../Utility/MappedFile.hpp"
+#include "../Utility/Vector.hpp"
+#include "../ComponentSystem/StandardComponents.hpp"
+
+namespace ECS
+{
+	//!@class PayloadTraits
+	//!@brief 値を固定長のバイト列に書き出す方法を定義します
+	//!@note 新しい値の型を使う場合はこれを特殊化してください
+	template<typename T, typename = void>
+	struct PayloadTraits;
+
+	template<typename T>
+	struct PayloadTraits<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>
+	{
+		static constexpr std::size_t Size = sizeof(T);
+		static void write(const T& value, std::byte* dst) noexcept
+		{
+			std::memcpy(dst, &value, sizeof(T));
+		}
+		static void read(T& value, const std::byte* src) noexcept
+		{
+			std::memcpy(&value, src, sizeof(T));
+		}
+	};
+
+	template<typename T>
+	struct PayloadTraits<Vector2Type<T>>
+	{
+		static constexpr std::size_t Size = sizeof(T) * 2;
+		static void write(const Vector2Type<T>& value, std::byte* dst) noexcept
+		{
+			const T v[] = { value.xValue, value.yValue };
+			std::memcpy(dst, v, Size);
+		}
+		static void read(Vector2Type<T>& value, const std::byte* src) noexcept
+		{
+			T v[2];
+			std::memcpy(v, src, Size);
+			value.xValue = v[0]; value.yValue = v[1];
+		}
+	};
+
+	template<typename T>
+	struct PayloadTraits<Vector3Type<T>>
+	{
+		static constexpr std::size_t Size = sizeof(T) * 3;
+		static void write(const Vector3Type<T>& value, std::byte* dst) noexcept
+		{
+			const T v[] = { value.xValue, value.yValue, value.zValue };
+			std::memcpy(dst, v, Size);
+		}
+		static void read(Vector3Type<T>& value, const std::byte* src) noexcept
+		{
+			T v[3];
+			std::memcpy(v, src, Size);
+			value.xValue = v[0]; value.yValue = v[1]; value.zValue = v[2];
+		}
+	};
+
+	template<typename T>
+	struct PayloadTraits<Vector4Type<T>>
+	{
+		static constexpr std::size_t Size = sizeof(T) * 4;
+		static void write(const Vector4Type<T>& value, std::byte* dst) noexcept
+		{
+			const T v[] = { value.xValue, value.yValue, value.zValue, value.wValue };
+			std::memcpy(dst, v, Size);
+		}
+		static void read(Vector4Type<T>& value, const std::byte* src) noexcept
+		{
+			T v[4];
+			std::memcpy(v, src, Size);
+			value.xValue = v[0]; value.yValue = v[1]; value.zValue = v[2]; value.wValue = v[3];
+		}
+	};
+
+	//!@class ComponentSerializer
+	//!@brief シリアライズできるComponentの登録と、シーンの保存・読み込みを行います
+	class ComponentSerializer final
+	{
+	public:
+		static constexpr std::uint32_t Magic = 0x4E435356; //"VSCN"
+		static constexpr std::uint32_t Version = 2;
+		static constexpr std::size_t NameLength = 48;
+
+		//!@brief 登録したComponentの情報
+		struct TypeInfo
+		{
+			std::string name;
+			std::size_t payloadSize = 0;
+			//値は Entity::getComponentAddress() のアドレスで受け渡します
+			std::function<void(const void*, std::byte*)> write;
+			std::function<void(void*, const std::byte*)> read;
+			//1つの列(Entity番号の配列, ペイロードの配列, 数)を[entities]に追加します
+			std::function<void(EntityManager&, Entity* const*, const std::byte*, const std::byte*, std::uint32_t)> readColumn;
+		};
+	private:
+		struct FileHeader
+		{
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint32_t typeCount;
+			std::uint32_t entityCount;
+		};
+		struct TypeEntry
+		{
+			char name[NameLength];
+			std::uint32_t payloadSize;
+			std::uint32_t componentCount;
+			std::uint64_t offset;
+		};
+	public:
+		//!@brief [T]を[name]で登録します
+		//!@brief [fields]に並べたメンバだけが保存されます([T]はデフォルト構築できること)
+		template<typename T, typename... Fields>
+		static void regist(const std::string& name, Fields T::*... fields)
+		{
+			assert(name.size() < NameLength);
+			TypeInfo info;
+			info.name = name;
+			info.payloadSize = (PayloadTraits<Fields>::Size + ... + 0);
+			info.write = [fields...](const void* component, std::byte* dst)
+			{
+				const T& c = componentCast<T>(component);
+				((PayloadTraits<Fields>::write(c.*fields, dst), dst += PayloadTraits<Fields>::Size), ...);
+			};
+			info.read = [fields...](void* component, const std::byte* src)
+			{
+				readFields(componentCast<T>(component), src, fields...);
+			};
+			info.readColumn = [fields...](EntityManager& manager, Entity* const* entities,
+				const std::byte* indices, const std::byte* payload, const std::uint32_t count)
+			{
+				constexpr std::size_t PayloadSize = (PayloadTraits<Fields>::Size + ... + 0);
+				const ComponentID id = getComponentTypeID<T>();
+				if constexpr (IsDataComponent<T>)
+				{
+					//プールに直接作り、ペイロードをそのまま書き込む
+					DataPool<T>& pool = manager.getDataPool<T>();
+					const std::uint32_t tick = getChangeTick();
+					for (std::uint32_t i = 0; i < count; ++i)
+					{
+						std::uint32_t index;
+						std::memcpy(&index, indices + sizeof(index) * i, sizeof(index));
+						Entity& entity = *entities[index];
+						T* value = pool.emplace(entity, tick);
+						readFields(*value, payload + PayloadSize * i, fields...);
+						entity.attachData(value, id, sizeof(T));
+					}
+				}
+				else
+				{
+					Memory::PoolAllocator::get().reserve(sizeof(T), count);
+					for (std::uint32_t i = 0; i < count; ++i)
+					{
+						std::uint32_t index;
+						std::memcpy(&index, indices + sizeof(index) * i, sizeof(index));
+						readFields(entities[index]->addComponent<T>(), payload + PayloadSize * i, fields...);
+					}
+				}
+			};
+			getTypes()[getComponentTypeID<T>()] = std::move(info);
+		}
+		//!@brief 標準のデータComponentを登録します
+		static void registStandardComponents()
+		{
+			regist<Position>("Position", &Position::position);
+			regist<Rotation>("Rotation", &Rotation::rotation);
+			regist<Scale>("Scale", &Scale::scale);
+			regist<Color>("Color", &Color::value);
+			regist<Gravity>("Gravity", &Gravity::value);
+			regist<Direction>("Direction", &Direction::value);
+		}
+		//!@brief 型IDの登録情報を取得します(未登録ならnullptr)
+		[[nodiscard]] static const TypeInfo* getTypeInfo(const ComponentID id) noexcept
+		{
+			const auto& types = getTypes();
+			const auto itr = types.find(id);
+			return itr == types.end() ? nullptr : &itr->second;
+		}
+		//!@brief 登録されているすべての型を取得します
+		[[nodiscard]] static const std::map<ComponentID, TypeInfo>& getRegisteredTypes() noexcept
+		{
+			return getTypes();
+		}
+
+		//!@brief [manager]の生きているEntityを[filePath]へ保存します
+		//!@return true:成功  false:失敗
+		static bool save(const EntityManager& manager, const std::string& filePath)
+		{
+			std::vector<std::byte> buffer;
+			write(manager, buffer);
+			std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				return false;
+			}
+			file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+			return static_cast<bool>(file);
+		}
+		//!@brief [manager]の生きているEntityを[buffer]へ書き出します
+		//!@brief [buffer]の容量は使い回すので、毎フレーム呼んでもヒープは伸びたときだけ使います
+		static void write(const EntityManager& manager, std::vector<std::byte>& buffer)
+		{
+			buffer.clear();
+			std::uint32_t entityCount = 0;
+			for (const auto& e : manager.getEntities())
+			{
+				if (e->isActive()) { ++entityCount; }
+			}
+			const auto& types = getTypes();
+			FileHeader header = { Magic, Version, static_cast<std::uint32_t>(types.size()), entityCount };
+			append(buffer, &header, sizeof(header));
+			const std::size_t tableOffset = buffer.size();
+			buffer.resize(buffer.size() + sizeof(TypeEntry) * types.size());
+
+			//Entityごとのグループ
+			for (const auto& e : manager.getEntities())
+			{
+				if (!e->isActive())
+				{
+					continue;
+				}
+				std::uint32_t groups = 0;
+				for (Group g = 0; g < MaxGroups; ++g)
+				{
+					if (e->hasGroup(g)) { groups |= 1u << g; }
+				}
+				append(buffer, &groups, sizeof(groups));
+			}
+			//Entityごとのタグ名(長さ + 文字列。タグなしは長さ 0)
+			for (const auto& e : manager.getEntities())
+			{
+				if (!e->isActive())
+				{
+					continue;
+				}
+				const std::string& tag = e->getTag();
+				const std::uint32_t length = static_cast<std::uint32_t>(tag.size());
+				append(buffer, &length, sizeof(length));
+				append(buffer, tag.data(), tag.size());
+			}
+
+			//型ごとの列
+			std::size_t typeIndex = 0;
+			for (const auto& type : types)
+			{
+				const std::size_t entryOffset = tableOffset + sizeof(TypeEntry) * typeIndex;
+				const std::size_t indexOffset = buffer.size();
+				std::uint32_t index = 0;
+				std::uint32_t componentCount = 0;
+				for (const auto& e : manager.getEntities())
+				{
+					if (!e->isActive())
+					{
+						continue;
+					}
+					if (e->hasComponent(type.first))
+					{
+						append(buffer, &index, sizeof(index));
+						++componentCount;
+					}
+					++index;
+				}
+				const std::size_t payloadOffset = buffer.size();
+				buffer.resize(payloadOffset + type.second.payloadSize * componentCount);
+				std::byte* dst = buffer.data() + payloadOffset;
+				for (const auto& e : manager.getEntities())
+				{
+					if (e->isActive() && e->hasComponent(type.first))
+					{
+						type.second.write(e->getComponentAddress(type.first), dst);
+						dst += type.second.payloadSize;
+					}
+				}
+				TypeEntry entry = {};
+				std::strncpy(entry.name, type.second.name.c_str(), NameLength - 1);
+				entry.payloadSize = static_cast<std::uint32_t>(type.second.payloadSize);
+				entry.componentCount = componentCount;
+				entry.offset = indexOffset;
+				std::memcpy(buffer.data() + entryOffset, &entry, sizeof(entry));
+				++typeIndex;
+			}
+		}
+
+		//!@brief [filePath]のシーンを[manager]へ追加します
+		//!@brief 登録されていない型、ペイロードのサイズが違う型は読み飛ばします
+		//!@return true:成功  false:失敗
+		static bool load(EntityManager& manager, const std::string& filePath)
+		{
+			MappedFile file(filePath);
+			if (!file.isOpen())
+			{
+				return false;
+			}
+			return load(manager, file.getData(), file.getSize());
+		}
+		//!@brief メモリ上のシーンを[manager]へ追加します
+		static bool load(EntityManager& manager, const std::byte* data, const std::size_t size)
+		{
+			FileHeader header;
+			if (size < sizeof(header))
+			{
+				return false;
+			}
+			std::memcpy(&header, data, sizeof(header));
+			if (!isValidHeader(header, size))
+			{
+				return false;
+			}
+			const std::size_t groupOffset = sizeof(header) + sizeof(TypeEntry) * header.typeCount;
+			if (header.entityCount > (size - groupOffset) / sizeof(std::uint32_t))
+			{
+				return false;
+			}
+			//タグ名の並びがデータに収まっているか、Entityを作る前に確かめる
+			const std::size_t tagOffset = groupOffset + sizeof(std::uint32_t) * header.entityCount;
+			std::size_t cursor = tagOffset;
+			for (std::uint32_t i = 0; i < header.entityCount; ++i)
+			{
+				std::uint32_t length;
+				if (size - cursor < sizeof(length))
+				{
+					return false;
+				}
+				std::memcpy(&length, data + cursor, sizeof(length));
+				cursor += sizeof(length);
+				if (length > size - cursor)
+				{
+					return false;
+				}
+				cursor += length;
+			}
+
+			//型の列とEntity番号もすべて確かめてから作る(途中で失敗して半端なシーンを残さない)
+			std::vector<const TypeInfo*> infos(header.typeCount);
+			std::vector<std::uint32_t> lastType(header.entityCount, UINT32_MAX);
+			for (std::uint32_t t = 0; t < header.typeCount; ++t)
+			{
+				TypeEntry entry;
+				std::memcpy(&entry, data + sizeof(header) + sizeof(TypeEntry) * t, sizeof(entry));
+				entry.name[NameLength - 1] = '\0';
+				const TypeInfo* info = findType(entry.name);
+				if (info == nullptr || info->payloadSize != entry.payloadSize)
+				{
+					std::cerr << "ComponentSerializer: skip " << entry.name << std::endl;
+					continue;
+				}
+				//列がデータからはみ出しているもの、同じ型の列が2つあるものは壊れている
+				if (!isColumnInRange(entry, size) || std::find(infos.begin(), infos.begin() + t, info) != infos.begin() + t)
+				{
+					return false;
+				}
+				const std::byte* indices = data + entry.offset;
+				for (std::uint32_t i = 0; i < entry.componentCount; ++i)
+				{
+					std::uint32_t index;
+					std::memcpy(&index, indices + sizeof(index) * i, sizeof(index));
+					//同じ列に同じEntityが2回あるものも壊れている
+					if (index >= header.entityCount || lastType[index] == t)
+					{
+						return false;
+					}
+					lastType[index] = t;
+				}
+				infos[t] = info;
+			}
+
+			//Entityをまとめて生成する
+			std::vector<Entity*> entities(header.entityCount);
+			manager.reserve(header.entityCount);
+			cursor = tagOffset;
+			for (std::uint32_t i = 0; i < header.entityCount; ++i)
+			{
+				std::uint32_t length;
+				std::memcpy(&length, data + cursor, sizeof(length));
+				cursor += sizeof(length);
+				if (length == 0)
+				{
+					entities[i] = &manager.addEntity();
+				}
+				else
+				{
+					//タグを付け直して getEntitiesByTag() で引けるようにする
+					entities[i] = &manager.addEntityAddTag(std::string(reinterpret_cast<const char*>(data + cursor), length));
+					cursor += length;
+				}
+				std::uint32_t groups;
+				std::memcpy(&groups, data + groupOffset + sizeof(groups) * i, sizeof(groups));
+				for (Group g = 0; groups != 0; ++g, groups >>= 1)
+				{
+					if (groups & 1u) { entities[i]->addGroup(g); }
+				}
+			}
+
+			//型ごとの列をまとめて読み込む
+			for (std::uint32_t t = 0; t < header.typeCount; ++t)
+			{
+				if (infos[t] == nullptr)
+				{
+					continue;
+				}
+				TypeEntry entry;
+				std::memcpy(&entry, data + sizeof(header) + sizeof(TypeEntry) * t, sizeof(entry));
+				const std::byte* indices = data + entry.offset;
+				const std::byte* payload = indices + sizeof(std::uint32_t) * entry.componentCount;
+				infos[t]->readColumn(manager, entities.data(), indices, payload, entry.componentCount);
+			}
+			return true;
+		}
+		//!@brief [manager]の今のEntityへペイロードだけを書き戻します
+		//!@brief Entityの並びとComponentの構成がデータと同じときだけ成功します
+		//!@return true:書き戻した  false:構成が違うので何もしていない
+		static bool apply(EntityManager& manager, const std::byte* data, const std::size_t size)
+		{
+			FileHeader header;
+			if (size < sizeof(header))
+			{
+				return false;
+			}
+			std::memcpy(&header, data, sizeof(header));
+			if (!isValidHeader(header, size))
+			{
+				return false;
+			}
+			//生きているEntityを並べる(フレームごとに呼ぶのでフレームアロケータを使う)
+			Memory::FrameVector<Entity*> entities(Memory::FrameAllocator::get().getResource());
+			entities.reserve(header.entityCount);
+			for (const auto& e : manager.getEntities())
+			{
+				if (e->isActive()) { entities.emplace_back(e.get()); }
+			}
+			if (entities.size() != header.entityCount)
+			{
+				return false;
+			}
+			//先に構成が一致するか確認する
+			const auto& types = getTypes();
+			if (header.typeCount != types.size())
+			{
+				return false;
+			}
+			std::array<const TypeInfo*, MaxComponents> infos{};
+			std::array<ComponentID, MaxComponents> ids{};
+			for (std::uint32_t t = 0; t < header.typeCount; ++t)
+			{
+				TypeEntry entry;
+				std::memcpy(&entry, data + sizeof(header) + sizeof(TypeEntry) * t, sizeof(entry));
+				entry.name[NameLength - 1] = '\0';
+				for (const auto& type : types)
+				{
+					if (type.second.name == entry.name) { infos[t] = &type.second; ids[t] = type.first; }
+				}
+				if (infos[t] == nullptr || infos[t]->payloadSize != entry.payloadSize || !isColumnInRange(entry, size))
+				{
+					return false;
+				}
+				std::uint32_t liveCount = 0;
+				for (const auto* e : entities)
+				{
+					if (e->hasComponent(ids[t])) { ++liveCount; }
+				}
+				const std::byte* indices = data + entry.offset;
+				for (std::uint32_t i = 0; i < entry.componentCount; ++i)
+				{
+					std::uint32_t index;
+					std::memcpy(&index, indices + sizeof(index) * i, sizeof(index));
+					if (index >= entities.size() || !entities[index]->hasComponent(ids[t]))
+					{
+						return false;
+					}
+				}
+				if (liveCount != entry.componentCount)
+				{
+					return false;
+				}
+			}
+			//一致したのでペイロードだけを書き戻す
+			for (std::uint32_t t = 0; t < header.typeCount; ++t)
+			{
+				TypeEntry entry;
+				std::memcpy(&entry, data + sizeof(header) + sizeof(TypeEntry) * t, sizeof(entry));
+				const std::byte* indices = data + entry.offset;
+				const std::byte* payload = indices + sizeof(std::uint32_t) * entry.componentCount;
+				for (std::uint32_t i = 0; i < entry.componentCount; ++i)
+				{
+					std::uint32_t index;
+					std::memcpy(&index, indices + sizeof(index) * i, sizeof(index));
+					infos[t]->read(entities[index]->getComponentAddress(ids[t]), payload + entry.payloadSize * i);
+					//書き戻した値を Changed<T> やキャッシュから見えるようにする
+					entities[index]->markChanged(ids[t]);
+				}
+			}
+			return true;
+		}
+	private:
+		//!@brief [src]のペイロードを[c]の[fields]へ読み込みます
+		template<typename T, typename... Fields>
+		static void readFields(T& c, const std::byte* src, Fields T::*... fields) noexcept
+		{
+			((PayloadTraits<Fields>::read(c.*fields, src), src += PayloadTraits<Fields>::Size), ...);
+		}
+		//!@brief 識別子と版が合っていて、型テーブルが[size]に収まっているか
+		static bool isValidHeader(const FileHeader& header, const std::size_t size) noexcept
+		{
+			return header.magic == Magic && header.version == Version &&
+				header.typeCount <= (size - sizeof(header)) / sizeof(TypeEntry);
+		}
+		//!@brief 型の列(Entity番号 + ペイロード)が[size]に収まっているか
+		//!@note 掛け算や足し算が溢れないように、残りの大きさを割って比べる
+		static bool isColumnInRange(const TypeEntry& entry, const std::size_t size) noexcept
+		{
+			return entry.offset <= size &&
+				entry.componentCount <= (size - entry.offset) / (sizeof(std::uint32_t) + entry.payloadSize);
+		}
+		static std::map<ComponentID, TypeInfo>& getTypes() noexcept
+		{
+			static std::map<ComponentID, TypeInfo> types;
+			return types;
+		}
+		static const TypeInfo* findType(const char* name) noexcept
+		{
+			for (const auto& type : getTypes())
+			{
+				if (type.second.name == name)
+				{
+					return &type.second;
+				}
+			}
+			return nullptr;
+		}
+		static void append(std::vector<std::byte>& buffer, const void* src, const std::size_t size)
+		{
+			const std::size_t offset = buffer.size();
+			buffer.resize(offset + size);
+			if (size != 0)
+			{
+				std::memcpy(buffer.data() + offset, src, size);
+			}
+		}
+	};
+}
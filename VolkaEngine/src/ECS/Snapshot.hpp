@@ -0,0 +1,189 @@
+//---------------------------------------------------------
+//!@file Snapshot.hpp
+//!@brief EntityManagerの状態を保存し、巻き戻せるようにします
+//!@author Volka
+//!@date 2018/11/3
+//!@note 保存されるのは ComponentSerializer に登録したComponentだけです
+//!@note フレーム間の差分は XOR + 0 の連続の圧縮で小さくします
+//---------------------------------------------------------
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "ECS.hpp"
+#include "Serialization.hpp"
+
+namespace ECS
+{
+	//!@class WorldSnapshot
+	//!@brief ある1フレームのEntityManagerの状態(連続したバッファ)
+	struct WorldSnapshot
+	{
+		std::uint64_t frame = 0;
+		std::vector<std::byte> data;
+	};
+
+	//!@class SnapshotSystem
+	//!@brief スナップショットの取得・復元と、差分の作成・適用を行います
+	class SnapshotSystem final
+	{
+	public:
+		//!@brief [manager]の状態を[snapshot]へ保存します
+		static void capture(const EntityManager& manager, const std::uint64_t frame, WorldSnapshot& snapshot)
+		{
+			snapshot.frame = frame;
+			ComponentSerializer::write(manager, snapshot.data);
+		}
+		//!@brief [snapshot]の状態を[manager]へ復元します
+		//!@brief Entityの構成が同じならペイロードだけを書き戻します
+		//!@param allowRebuild 構成が違うとき、Entityをすべて作り直してよいか
+		//!@note 作り直すと登録していないComponent(描画など)は失われます
+		//!@return true:復元した  false:構成が違うので何もしていない
+		static bool restore(EntityManager& manager, const WorldSnapshot& snapshot, const bool allowRebuild = false)
+		{
+			if (ComponentSerializer::apply(manager, snapshot.data.data(), snapshot.data.size()))
+			{
+				return true;
+			}
+			if (!allowRebuild)
+			{
+				return false;
+			}
+			manager.allKill();
+			manager.refresh();
+			return ComponentSerializer::load(manager, snapshot.data.data(), snapshot.data.size());
+		}
+		//!@brief [base]から[target]への差分を[delta]へ書き出します
+		//!@note 形式: 全体のサイズ, (0の長さ, リテラルの長さ, XORしたリテラル) の繰り返し
+		static void encodeDelta(const WorldSnapshot& base, const WorldSnapshot& target, std::vector<std::byte>& delta)
+		{
+			delta.clear();
+			const std::size_t size = target.data.size();
+			appendValue(delta, static_cast<std::uint32_t>(size));
+			std::size_t i = 0;
+			while (i < size)
+			{
+				const std::size_t zeroBegin = i;
+				while (i < size && xorAt(base, target, i) == std::byte{ 0 }) { ++i; }
+				const std::size_t literalBegin = i;
+				//短い0の並びはリテラルに含めたほうが小さくなる
+				std::size_t zeroCount = 0;
+				while (i < size && zeroCount < RunThreshold)
+				{
+					zeroCount = xorAt(base, target, i) == std::byte{ 0 } ? zeroCount + 1 : 0;
+					++i;
+				}
+				const std::size_t literalEnd = zeroCount >= RunThreshold ? i - zeroCount : i;
+				i = literalEnd;
+				appendValue(delta, static_cast<std::uint32_t>(literalBegin - zeroBegin));
+				appendValue(delta, static_cast<std::uint32_t>(literalEnd - literalBegin));
+				const std::size_t offset = delta.size();
+				delta.resize(offset + literalEnd - literalBegin);
+				for (std::size_t j = literalBegin; j < literalEnd; ++j)
+				{
+					delta[offset + j - literalBegin] = xorAt(base, target, j);
+				}
+			}
+		}
+		//!@brief [base]に[delta]を適用して[out]を作ります
+		//!@return true:成功  false:差分が壊れている
+		static bool decodeDelta(const WorldSnapshot& base, const std::vector<std::byte>& delta, const std::uint64_t frame, WorldSnapshot& out)
+		{
+			std::size_t read = 0;
+			std::uint32_t size = 0;
+			if (!readValue(delta, read, size))
+			{
+				return false;
+			}
+			out.frame = frame;
+			out.data.resize(size);
+			const std::size_t copySize = base.data.size() < size ? base.data.size() : size;
+			std::memcpy(out.data.data(), base.data.data(), copySize);
+			std::memset(out.data.data() + copySize, 0, size - copySize);
+			std::size_t write = 0;
+			while (write < size)
+			{
+				std::uint32_t zeroCount = 0;
+				std::uint32_t literalCount = 0;
+				if (!readValue(delta, read, zeroCount) || !readValue(delta, read, literalCount) ||
+					write + zeroCount + literalCount > size || read + literalCount > delta.size())
+				{
+					return false;
+				}
+				write += zeroCount;
+				for (std::uint32_t j = 0; j < literalCount; ++j)
+				{
+					out.data[write + j] ^= delta[read + j];
+				}
+				write += literalCount;
+				read += literalCount;
+			}
+			return true;
+		}
+	private:
+		static constexpr std::size_t RunThreshold = 8;
+		static std::byte xorAt(const WorldSnapshot& base, const WorldSnapshot& target, const std::size_t index) noexcept
+		{
+			const std::byte b = index < base.data.size() ? base.data[index] : std::byte{ 0 };
+			return target.data[index] ^ b;
+		}
+		static void appendValue(std::vector<std::byte>& buffer, const std::uint32_t value)
+		{
+			const std::size_t offset = buffer.size();
+			buffer.resize(offset + sizeof(value));
+			std::memcpy(buffer.data() + offset, &value, sizeof(value));
+		}
+		static bool readValue(const std::vector<std::byte>& buffer, std::size_t& offset, std::uint32_t& value) noexcept
+		{
+			if (offset + sizeof(value) > buffer.size())
+			{
+				return false;
+			}
+			std::memcpy(&value, buffer.data() + offset, sizeof(value));
+			offset += sizeof(value);
+			return true;
+		}
+	};
+
+	//!@class RollbackBuffer
+	//!@brief 直近[frameNum]フレーム分のスナップショットを持ち、巻き戻しに使います
+	//!@note バッファは使い回すので、容量が足りていれば毎フレームの保存でヒープを使いません
+	class RollbackBuffer final
+	{
+	public:
+		explicit RollbackBuffer(const std::size_t frameNum = 8)
+			: snapshots(frameNum), valid(frameNum, false)
+		{}
+		//!@brief [frame]の状態として[manager]を保存します
+		void save(const EntityManager& manager, const std::uint64_t frame)
+		{
+			WorldSnapshot& snapshot = snapshots[frame % snapshots.size()];
+			SnapshotSystem::capture(manager, frame, snapshot);
+			valid[frame % snapshots.size()] = true;
+		}
+		//!@brief [frame]の状態が残っているか
+		[[nodiscard]] bool hasFrame(const std::uint64_t frame) const noexcept
+		{
+			const std::size_t index = frame % snapshots.size();
+			return valid[index] && snapshots[index].frame == frame;
+		}
+		//!@brief [manager]を[frame]の状態へ巻き戻します
+		//!@return true:成功  false:残っていない/構成が違う
+		bool rollback(EntityManager& manager, const std::uint64_t frame, const bool allowRebuild = false)
+		{
+			if (!hasFrame(frame))
+			{
+				return false;
+			}
+			return SnapshotSystem::restore(manager, snapshots[frame % snapshots.size()], allowRebuild);
+		}
+		//!@brief [frame]のスナップショットを取得します
+		[[nodiscard]] const WorldSnapshot& getSnapshot(const std::uint64_t frame) const noexcept
+		{
+			return snapshots[frame % snapshots.size()];
+		}
+	private:
+		std::vector<WorldSnapshot> snapshots;
+		std::vector<bool> valid;
+	};
+}
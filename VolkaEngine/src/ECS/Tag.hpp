@@ -0,0 +1,72 @@
+//---------------------------------------------------------
+//!@file Tag.hpp
+//!@brief Entityのタグの文字列を番号(TagID)に置き換えて管理します
+//!@author Volka
+//!@date 2018/11/3
+//!@note 同じ文字列は常に同じ番号になるので、Entityは番号だけを持ちます
+//---------------------------------------------------------
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ECS
+{
+	using TagID = std::uint32_t;
+	//タグなし(空の文字列)
+	constexpr TagID NoTag = 0;
+
+	//!@class TagRegistry
+	class TagRegistry final
+	{
+	public:
+		//!@brief [name]の番号を取得します(初めての文字列なら登録します)
+		[[nodiscard]] TagID intern(const std::string& name)
+		{
+			if (name.empty())
+			{
+				return NoTag;
+			}
+			std::lock_guard<std::mutex> guard(mutex);
+			const auto itr = ids.find(name);
+			if (itr != ids.end())
+			{
+				return itr->second;
+			}
+			names.emplace_back(name);
+			const TagID id = static_cast<TagID>(names.size() - 1);
+			ids.emplace(name, id);
+			return id;
+		}
+		//!@brief [name]の番号を取得します(登録されていなければ NoTag)
+		[[nodiscard]] TagID find(const std::string& name) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			const auto itr = ids.find(name);
+			return itr == ids.end() ? NoTag : itr->second;
+		}
+		//!@brief [id]の文字列を取得します
+		//!@note 登録した文字列は消さないので、参照はずっと有効です
+		[[nodiscard]] const std::string& getName(const TagID id) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			return names[id];
+		}
+		[[nodiscard]] static TagRegistry& get() noexcept
+		{
+			static TagRegistry tagRegistry;
+			return tagRegistry;
+		}
+	private:
+		TagRegistry()
+		{
+			names.emplace_back();
+		}
+	private:
+		std::unordered_map<std::string, TagID> ids;
+		std::deque<std::string> names;
+		mutable std::mutex mutex;
+	};
+}
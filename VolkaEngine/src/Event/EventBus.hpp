@@ -0,0 +1,196 @@
+//---------------------------------------------------------
+//!@file EventBus.hpp
+//!@brief 型ごとのイベントキューとフレーム単位の配信を行います
+//!@author Volka
+//!@date 2018/11/3
+//!@note 発行されたイベントは次のフレームにまとめて読めるようになります(ダブルバッファ)
+//!@note 発行はロックを取らないので、ワーカースレッドから呼んでも構いません
+//!@note subscribe() した関数には、入れ替えの後に1回だけまとめて配ります(受け取る側がそれぞれ全部を読まない)
+//---------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Event
+{
+	//!@class EventSpan
+	//!@brief 読み込み側に渡す連続したイベントの範囲
+	template<typename T>
+	class EventSpan final
+	{
+	public:
+		EventSpan(const T* first, const std::size_t count) noexcept
+			: first(first), count(count)
+		{}
+		[[nodiscard]] const T* begin() const noexcept { return first; }
+		[[nodiscard]] const T* end() const noexcept { return first + count; }
+		[[nodiscard]] std::size_t size() const noexcept { return count; }
+		[[nodiscard]] bool empty() const noexcept { return count == 0; }
+		[[nodiscard]] const T& operator[](const std::size_t index) const noexcept { return first[index]; }
+	private:
+		const T* first;
+		std::size_t count;
+	};
+
+	//!@class IEventQueue
+	//!@brief EventBusがまとめて入れ替えるためのインターフェース
+	class IEventQueue
+	{
+	public:
+		virtual ~IEventQueue() = default;
+		virtual void swap() noexcept = 0;
+	};
+
+	//!@class EventQueue
+	//!@brief 1つのイベント型の固定長キュー
+	//!@note 書き込みは atomic な fetch_add で位置を取るだけです
+	//!@note 容量を超えたイベントは捨てて、その数を数えます
+	template<typename T>
+	class EventQueue final : public IEventQueue
+	{
+	public:
+		static constexpr std::size_t DefaultCapacity = 1024;
+	public:
+		explicit EventQueue(const std::size_t capacity = DefaultCapacity)
+			: capacity(capacity),
+			buffers{ std::make_unique<T[]>(capacity), std::make_unique<T[]>(capacity) }
+		{}
+		//!@brief イベントを発行します(どのスレッドからでも呼べます)
+		//!@return true:成功  false:キューがいっぱい
+		bool publish(const T& event) noexcept
+		{
+			const std::size_t index = writeCount.fetch_add(1, std::memory_order_relaxed);
+			if (index >= capacity)
+			{
+				droppedCount.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			buffers[writeIndex][index] = event;
+			return true;
+		}
+		//!@brief 前のフレームに発行されたイベントをまとめて取得します
+		[[nodiscard]] EventSpan<T> read() const noexcept
+		{
+			return EventSpan<T>(buffers[writeIndex ^ 1].get(), readCount);
+		}
+		//!@brief フレームの区切りで書き込み側と読み込み側を入れ替えます
+		//!@note 発行しているスレッドがいない状態で呼んでください
+		void swap() noexcept override
+		{
+			const std::size_t written = writeCount.exchange(0, std::memory_order_acquire);
+			readCount = written < capacity ? written : capacity;
+			writeIndex ^= 1;
+		}
+		//!@brief 容量が足りずに捨てたイベントの数を取得します
+		[[nodiscard]] std::size_t getDroppedCount() const noexcept
+		{
+			return droppedCount.load(std::memory_order_relaxed);
+		}
+	private:
+		const std::size_t capacity;
+		std::unique_ptr<T[]> buffers[2];
+		std::atomic<std::size_t> writeCount{ 0 };
+		std::atomic<std::size_t> droppedCount{ 0 };
+		std::size_t readCount = 0;
+		std::size_t writeIndex = 0;
+	};
+
+	//!@class EventBus
+	//!@brief 型ごとのEventQueueを管理し、フレームごとにまとめて入れ替えます
+	class EventBus final
+	{
+	public:
+		//!@brief [T]のキューを取得します(初回に作ります)
+		template<typename T> [[nodiscard]] EventQueue<T>& getQueue()
+		{
+			static EventQueue<T>& queue = registQueue<T>();
+			return queue;
+		}
+		//!@brief [T]のイベントを発行します
+		template<typename T> bool publish(const T& event)
+		{
+			return getQueue<T>().publish(event);
+		}
+		//!@brief 前のフレームに発行された[T]のイベントをまとめて取得します
+		template<typename T> [[nodiscard]] EventSpan<T> read()
+		{
+			return getQueue<T>().read();
+		}
+		//!@brief 前のフレームに発行された[T]のイベントを、フレームごとに1回[handler]へ1つずつ渡すように登録します
+		//!@note Componentごとに登録せず、型ごとに1つの関数で宛先を引いて配ってください
+		template<typename T> void subscribe(std::function<void(const T&)> handler)
+		{
+			EventQueue<T>* queue = &getQueue<T>();
+			std::lock_guard<std::mutex> guard(mutex);
+			handlers.emplace_back([queue, handler = std::move(handler)]()
+			{
+				for (const auto& event : queue->read())
+				{
+					handler(event);
+				}
+			});
+		}
+		//!@brief subscribe() した関数に、前のフレームのイベントを配ります(swap() の後に呼ばれます)
+		//!@note 配っている間は subscribe() できません
+		void dispatch()
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			for (auto& handler : handlers)
+			{
+				handler();
+			}
+		}
+		//!@brief [T]のキューの容量を指定します(最初に使う前に呼んでください)
+		template<typename T> void setCapacity(const std::size_t capacity)
+		{
+			capacities().emplace_back(typeKey<T>(), capacity);
+		}
+		//!@brief すべてのキューを入れ替えます(フレームの先頭で呼ばれます)
+		void swap() noexcept
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			for (auto& queue : queues)
+			{
+				queue->swap();
+			}
+		}
+		[[nodiscard]] static EventBus& get() noexcept
+		{
+			static EventBus eventBus;
+			return eventBus;
+		}
+	private:
+		using TypeKey = const void*;
+		template<typename T> static TypeKey typeKey() noexcept
+		{
+			static const char key = 0;
+			return &key;
+		}
+		static std::vector<std::pair<TypeKey, std::size_t>>& capacities()
+		{
+			static std::vector<std::pair<TypeKey, std::size_t>> table;
+			return table;
+		}
+		template<typename T> EventQueue<T>& registQueue()
+		{
+			std::size_t capacity = EventQueue<T>::DefaultCapacity;
+			for (const auto& c : capacities())
+			{
+				if (c.first == typeKey<T>()) { capacity = c.second; }
+			}
+			auto queue = std::make_unique<EventQueue<T>>(capacity);
+			EventQueue<T>& ref = *queue;
+			std::lock_guard<std::mutex> guard(mutex);
+			queues.emplace_back(std::move(queue));
+			return ref;
+		}
+	private:
+		std::vector<std::unique_ptr<IEventQueue>> queues;
+		std::vector<std::function<void()>> handlers;
+		std::mutex mutex;
+	};
+}
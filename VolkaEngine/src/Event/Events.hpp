@@ -0,0 +1,75 @@
+//---------------------------------------------------------
+//!@file Events.hpp
+//!@brief エンジンが発行する標準のイベント群を用意します
+//!@author Volka
+//!@date 2018/11/3
+//!@note どれもコピーだけで扱える型にしておくこと(キューにそのまま並べるため)
+//!@note Entity はポインタではなく EntityHandle で指すこと(読まれる前に解放されて使い回されることがあるため)
+//---------------------------------------------------------
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "../ECS/EntityHandle.hpp"
+
+namespace Event
+{
+	//!@class CollisionEvent
+	//!@brief 2つのEntityの衝突
+	struct CollisionEvent
+	{
+		ECS::EntityHandle first;
+		ECS::EntityHandle second;
+	};
+
+	//!@class InputEvent
+	//!@brief キー・マウスなどの入力
+	struct InputEvent
+	{
+		std::uint32_t type;		//SDL_Event::type
+		std::int32_t code;		//キーコード/ボタン
+		std::int32_t x;
+		std::int32_t y;
+		std::uint32_t timestamp;
+	};
+
+	//!@class EntityDestroyedEvent
+	//!@brief Entityが削除された
+	//!@note 受け取った時点では解放済みなので、ハンドルは比較にだけ使うこと
+	struct EntityDestroyedEvent
+	{
+		ECS::EntityHandle entity;
+	};
+
+	//!@class CounterExpiredEvent
+	//!@brief Counter が最大のカウントに達した
+	struct CounterExpiredEvent
+	{
+		ECS::EntityHandle entity;
+	};
+
+	//!@class BlendChangedEvent
+	//!@brief BlendMode の設定が変わった
+	struct BlendChangedEvent
+	{
+		ECS::EntityHandle entity;
+		std::uint32_t blendMode;	//SDL_BlendMode
+		std::uint8_t alpha;
+	};
+
+	//!@class AssetLoadedEvent
+	//!@brief アセットが読み込まれた
+	struct AssetLoadedEvent
+	{
+		static constexpr std::size_t NameLength = 64;
+		char name[NameLength];
+
+		//!@brief [assetName]から作ります(長すぎる名前は切り詰めます)
+		static AssetLoadedEvent create(const std::string& assetName) noexcept
+		{
+			AssetLoadedEvent event = {};
+			std::strncpy(event.name, assetName.c_str(), NameLength - 1);
+			return event;
+		}
+	};
+}
@@ -0,0 +1,553 @@
+//---------------------------------------------------------
+//!@file InputSystem.hpp
+//!@brief キーボード・マウス・ゲームパッドの入力を扱います
+//!@author Volka
+//!@date 2018/11/3
+//!@note フレームの先頭で1回だけイベントを読み、フレーム中はその状態を参照します
+//!@note 状態はビットセットなので、そのまま記録・再生できます
+//!@note 記録にはフレームごとの状態に加えて、キーを押した・離した時刻と発行した InputEvent も含めます
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Event/EventBus.hpp"
+#include "../Event/Events.hpp"
+#include "../Utility/Runtime.hpp"
+
+namespace Input
+{
+	enum class Key : Uint32
+	{
+		A = SDLK_a,
+		B = SDLK_b,
+		C = SDLK_c,
+		D = SDLK_d,
+		E = SDLK_e,
+		F = SDLK_f,
+		G = SDLK_g,
+		H = SDLK_h,
+		I = SDLK_i,
+		J = SDLK_j,
+		K = SDLK_k,
+		L = SDLK_l,
+		M = SDLK_m,
+		N = SDLK_n,
+		O = SDLK_o,
+		P = SDLK_p,
+		Q = SDLK_q,
+		R = SDLK_r,
+		S = SDLK_s,
+		T = SDLK_t,
+		U = SDLK_u,
+		V = SDLK_v,
+		W = SDLK_w,
+		X = SDLK_x,
+		Y = SDLK_y,
+		Z = SDLK_z,
+		Space = SDLK_SPACE,
+		Return = SDLK_RETURN,
+		Escape = SDLK_ESCAPE,
+		Up = SDLK_UP,
+		Down = SDLK_DOWN,
+		Left = SDLK_LEFT,
+		Right = SDLK_RIGHT,
+	};
+
+	enum class MouseButton : Uint8
+	{
+		Left = SDL_BUTTON_LEFT,
+		Middle = SDL_BUTTON_MIDDLE,
+		Right = SDL_BUTTON_RIGHT,
+	};
+
+	constexpr std::size_t KeyNum = SDL_NUM_SCANCODES;
+	constexpr std::size_t MouseButtonNum = 8;
+	constexpr std::size_t PadAxisNum = SDL_CONTROLLER_AXIS_MAX;
+	constexpr std::size_t PadButtonNum = SDL_CONTROLLER_BUTTON_MAX;
+
+	using KeyBitSet = std::bitset<KeyNum>;
+	using ActionID = std::size_t;
+
+	//!@class InputState
+	//!@brief 1フレーム分の入力の状態
+	//!@note 記録・再生ではこれをそのままコピーします
+	struct InputState
+	{
+		KeyBitSet down;
+		KeyBitSet pressed;
+		KeyBitSet released;
+		std::bitset<MouseButtonNum> mouseDown;
+		std::bitset<MouseButtonNum> mousePressed;
+		std::bitset<MouseButtonNum> mouseReleased;
+		std::int32_t mouseX = 0;
+		std::int32_t mouseY = 0;
+		std::int32_t mouseDeltaX = 0;
+		std::int32_t mouseDeltaY = 0;
+		std::int32_t wheelX = 0;
+		std::int32_t wheelY = 0;
+		std::array<float, PadAxisNum> padAxis{};
+		std::bitset<PadButtonNum> padDown;
+		std::bitset<PadButtonNum> padPressed;
+		std::bitset<PadButtonNum> padReleased;
+		bool quit = false;
+		//!@brief 押した・離したなど、このフレームだけの情報を消します
+		void clearTransient() noexcept
+		{
+			pressed.reset();
+			released.reset();
+			mousePressed.reset();
+			mouseReleased.reset();
+			padPressed.reset();
+			padReleased.reset();
+			mouseDeltaX = mouseDeltaY = 0;
+			wheelX = wheelY = 0;
+		}
+	};
+
+	//!@class InputSystem
+	//!@brief 入力をフレーム単位でまとめて扱います
+	class InputSystem final
+	{
+	public:
+		static constexpr std::uint32_t RecordMagic = 0x504E4956; //"VINP"
+		static constexpr std::uint32_t RecordVersion = 1;
+	public:
+		enum class Mode
+		{
+			Live,		//そのまま使う
+			Record,		//使いながら記録する
+			Replay,		//記録したものを再生する
+		};
+	public:
+		virtual ~InputSystem()
+		{
+			if (controller != nullptr)
+			{
+				SDL_GameControllerClose(controller);
+			}
+		}
+		//!@brief フレームの先頭で呼び、溜まったイベントをすべて読みます
+		void update() noexcept
+		{
+			frameStartTime = Runtime::get().getTicks();
+			if (mode == Mode::Replay)
+			{
+				//再生中は記録した状態だけを使う(ウィンドウを閉じる操作だけは受け付ける)
+				bool quit = state.quit;
+				SDL_Event event;
+				while (SDL_PollEvent(&event) != 0)
+				{
+					if (event.type == SDL_QUIT) { quit = true; }
+				}
+				if (replayIndex < record.size())
+				{
+					const RecordFrame& frame = record[replayIndex++];
+					state = frame.state;
+					frameStartTime = frame.frameStartTime;
+					for (std::uint32_t i = 0; i < frame.transitionNum; ++i, ++transitionIndex)
+					{
+						transitionTime[recordTransitions[transitionIndex].scancode] = recordTransitions[transitionIndex].time;
+					}
+					//記録したときと同じイベントを同じ順に発行する
+					for (std::uint32_t i = 0; i < frame.eventNum; ++i, ++eventIndex)
+					{
+						Event::EventBus::get().publish(recordEvents[eventIndex]);
+					}
+				}
+				else
+				{
+					state.clearTransient();
+				}
+				state.quit = state.quit || quit;
+				return;
+			}
+			state.clearTransient();
+			SDL_Event event;
+			while (SDL_PollEvent(&event) != 0)
+			{
+				handleEvent(event);
+			}
+			if (mode == Mode::Record)
+			{
+				RecordFrame frame;
+				frame.state = state;
+				frame.frameStartTime = frameStartTime;
+				frame.transitionNum = static_cast<std::uint32_t>(recordTransitions.size() - transitionIndex);
+				frame.eventNum = static_cast<std::uint32_t>(recordEvents.size() - eventIndex);
+				record.emplace_back(frame);
+				transitionIndex = recordTransitions.size();
+				eventIndex = recordEvents.size();
+			}
+		}
+		//!@brief 押している間 true を返します
+		[[nodiscard]] bool isDown(const Key key) const noexcept
+		{
+			return state.down[toScancode(key)];
+		}
+		//!@brief このフレームに押されたら true を返します
+		[[nodiscard]] bool isPressed(const Key key) const noexcept
+		{
+			return state.pressed[toScancode(key)];
+		}
+		//!@brief このフレームに離されたら true を返します
+		[[nodiscard]] bool isReleased(const Key key) const noexcept
+		{
+			return state.released[toScancode(key)];
+		}
+		//!@brief 最後に押した・離したときの時刻[ms]を取得します
+		//!@note getFrameStartTime() と比べるとフレーム内のどこで入力されたか分かります
+		[[nodiscard]] Uint32 getTransitionTime(const Key key) const noexcept
+		{
+			return transitionTime[toScancode(key)];
+		}
+		//!@brief このフレームの入力を読んだ時刻[ms]を取得します
+		//!@note ヘッドレスではシミュレーションの時刻です(Runtime::getTicks())
+		[[nodiscard]] Uint32 getFrameStartTime() const noexcept
+		{
+			return frameStartTime;
+		}
+		[[nodiscard]] bool isMouseDown(const MouseButton button) const noexcept
+		{
+			return state.mouseDown[static_cast<std::size_t>(button)];
+		}
+		[[nodiscard]] bool isMousePressed(const MouseButton button) const noexcept
+		{
+			return state.mousePressed[static_cast<std::size_t>(button)];
+		}
+		[[nodiscard]] bool isMouseReleased(const MouseButton button) const noexcept
+		{
+			return state.mouseReleased[static_cast<std::size_t>(button)];
+		}
+		//!@brief ゲームパッドの軸の値(-1～1)を取得します
+		[[nodiscard]] float getPadAxis(const std::size_t axis) const noexcept
+		{
+			return state.padAxis[axis];
+		}
+		[[nodiscard]] bool isPadDown(const std::size_t button) const noexcept
+		{
+			return state.padDown[button];
+		}
+		[[nodiscard]] bool isPadPressed(const std::size_t button) const noexcept
+		{
+			return state.padPressed[button];
+		}
+		//!@brief 現在の状態を取得します
+		[[nodiscard]] const InputState& getState() const noexcept
+		{
+			return state;
+		}
+		//!@brief ウィンドウが閉じられたか
+		[[nodiscard]] bool push() const noexcept
+		{
+			return state.quit;
+		}
+
+		//!@brief [action]に[key]を割り当て、アクションのIDを返します
+		ActionID bindAction(const std::string& action, const Key key)
+		{
+			const ActionID id = getActionID(action);
+			actionBindings[id].emplace_back(toScancode(key));
+			return id;
+		}
+		//!@brief [action]のIDを取得します(なければ作ります)
+		ActionID getActionID(const std::string& action)
+		{
+			const auto itr = actionIDs.find(action);
+			if (itr != actionIDs.end())
+			{
+				return itr->second;
+			}
+			const ActionID id = actionBindings.size();
+			actionIDs[action] = id;
+			actionBindings.emplace_back();
+			return id;
+		}
+		//!@brief 割り当てたキーのどれかを押している間 true を返します
+		[[nodiscard]] bool isActionDown(const ActionID id) const noexcept
+		{
+			for (const auto scancode : actionBindings[id])
+			{
+				if (state.down[scancode]) { return true; }
+			}
+			return false;
+		}
+		//!@brief 割り当てたキーのどれかがこのフレームに押されたら true を返します
+		[[nodiscard]] bool isActionPressed(const ActionID id) const noexcept
+		{
+			for (const auto scancode : actionBindings[id])
+			{
+				if (state.pressed[scancode]) { return true; }
+			}
+			return false;
+		}
+
+		//!@brief 入力の記録を開始します
+		void startRecording()
+		{
+			record.clear();
+			recordTransitions.clear();
+			recordEvents.clear();
+			//記録を始める前に押したキーの時刻も、最初のフレームで戻せるようにする
+			for (std::size_t scancode = 0; scancode < KeyNum; ++scancode)
+			{
+				if (transitionTime[scancode] != 0)
+				{
+					recordTransitions.push_back({ static_cast<std::uint32_t>(scancode), transitionTime[scancode] });
+				}
+			}
+			transitionIndex = 0;
+			eventIndex = 0;
+			mode = Mode::Record;
+		}
+		//!@brief 記録した入力の再生を開始します
+		void startReplay() noexcept
+		{
+			replayIndex = 0;
+			transitionIndex = 0;
+			eventIndex = 0;
+			state = InputState();
+			transitionTime.fill(0);
+			mode = Mode::Replay;
+		}
+		//!@brief 通常の入力に戻します
+		void stop() noexcept
+		{
+			mode = Mode::Live;
+		}
+		[[nodiscard]] Mode getMode() const noexcept
+		{
+			return mode;
+		}
+		//!@brief 再生が最後まで終わったか
+		[[nodiscard]] bool isReplayFinished() const noexcept
+		{
+			return mode == Mode::Replay && replayIndex >= record.size();
+		}
+		//!@brief 記録を[filePath]に保存します
+		//!@note ヘッダー + フレームの配列 + キーの時刻の配列 + InputEvent の配列です
+		bool saveRecord(const std::string& filePath) const
+		{
+			std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				return false;
+			}
+			const RecordHeader header = {
+				RecordMagic, RecordVersion,
+				static_cast<std::uint32_t>(sizeof(InputState)), static_cast<std::uint32_t>(sizeof(Event::InputEvent)),
+				static_cast<std::uint32_t>(record.size()), static_cast<std::uint32_t>(recordTransitions.size()), static_cast<std::uint32_t>(recordEvents.size()) };
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(sizeof(RecordFrame) * record.size()));
+			file.write(reinterpret_cast<const char*>(recordTransitions.data()), static_cast<std::streamsize>(sizeof(KeyTransition) * recordTransitions.size()));
+			file.write(reinterpret_cast<const char*>(recordEvents.data()), static_cast<std::streamsize>(sizeof(Event::InputEvent) * recordEvents.size()));
+			return static_cast<bool>(file);
+		}
+		//!@brief [filePath]から記録を読み込みます
+		//!@return false:読めない、または別のビルド(InputState の大きさが違う)で記録したもの
+		bool loadRecord(const std::string& filePath)
+		{
+			std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+			if (!file)
+			{
+				return false;
+			}
+			const std::uint64_t size = static_cast<std::uint64_t>(file.tellg());
+			file.seekg(0);
+			RecordHeader header;
+			if (size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			{
+				return false;
+			}
+			if (header.magic != RecordMagic || header.version != RecordVersion ||
+				header.stateSize != sizeof(InputState) || header.eventSize != sizeof(Event::InputEvent))
+			{
+				return false;
+			}
+			//数は32bitなので、64bitで足しても溢れない
+			const std::uint64_t bodySize = sizeof(RecordFrame) * static_cast<std::uint64_t>(header.frameNum) +
+				sizeof(KeyTransition) * static_cast<std::uint64_t>(header.transitionNum) +
+				sizeof(Event::InputEvent) * static_cast<std::uint64_t>(header.eventNum);
+			if (size - sizeof(header) != bodySize)
+			{
+				return false;
+			}
+			std::vector<RecordFrame> frames(header.frameNum);
+			std::vector<KeyTransition> transitions(header.transitionNum);
+			std::vector<Event::InputEvent> events(header.eventNum);
+			file.read(reinterpret_cast<char*>(frames.data()), static_cast<std::streamsize>(sizeof(RecordFrame) * frames.size()));
+			file.read(reinterpret_cast<char*>(transitions.data()), static_cast<std::streamsize>(sizeof(KeyTransition) * transitions.size()));
+			file.read(reinterpret_cast<char*>(events.data()), static_cast<std::streamsize>(sizeof(Event::InputEvent) * events.size()));
+			if (!file)
+			{
+				return false;
+			}
+			//フレームが指す数と配列の長さが合っているか
+			std::uint64_t transitionSum = 0;
+			std::uint64_t eventSum = 0;
+			for (const auto& frame : frames)
+			{
+				transitionSum += frame.transitionNum;
+				eventSum += frame.eventNum;
+			}
+			if (transitionSum != transitions.size() || eventSum != events.size())
+			{
+				return false;
+			}
+			for (const auto& transition : transitions)
+			{
+				if (transition.scancode >= KeyNum)
+				{
+					return false;
+				}
+			}
+			record.swap(frames);
+			recordTransitions.swap(transitions);
+			recordEvents.swap(events);
+			return true;
+		}
+		[[nodiscard]] static InputSystem& get() noexcept
+		{
+			static InputSystem inputSystem;
+			return inputSystem;
+		}
+	private:
+		struct RecordHeader
+		{
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint32_t stateSize;	//sizeof(InputState)
+			std::uint32_t eventSize;	//sizeof(Event::InputEvent)
+			std::uint32_t frameNum;
+			std::uint32_t transitionNum;
+			std::uint32_t eventNum;
+		};
+		//!@brief 1フレーム分の記録
+		//!@note キーの時刻と InputEvent は別の配列に、このフレームの分の数だけ続けて置きます
+		struct RecordFrame
+		{
+			InputState state;
+			Uint32 frameStartTime = 0;
+			std::uint32_t transitionNum = 0;
+			std::uint32_t eventNum = 0;
+		};
+		//!@brief キーを押した・離した時刻
+		struct KeyTransition
+		{
+			std::uint32_t scancode;
+			Uint32 time;
+		};
+		static SDL_Scancode toScancode(const Key key) noexcept
+		{
+			return SDL_GetScancodeFromKey(static_cast<SDL_Keycode>(key));
+		}
+		static float normalizeAxis(const Sint16 value) noexcept
+		{
+			return value < 0 ? value / 32768.0f : value / 32767.0f;
+		}
+		void handleEvent(const SDL_Event& event) noexcept
+		{
+			switch (event.type)
+			{
+			case SDL_QUIT:
+				state.quit = true;
+				break;
+			case SDL_KEYDOWN:
+				if (event.key.repeat == 0)
+				{
+					setKey(event.key.keysym.scancode, true, event.key.timestamp);
+				}
+				publish(Event::InputEvent{ event.type, event.key.keysym.sym, 0, 0, event.key.timestamp });
+				break;
+			case SDL_KEYUP:
+				setKey(event.key.keysym.scancode, false, event.key.timestamp);
+				publish(Event::InputEvent{ event.type, event.key.keysym.sym, 0, 0, event.key.timestamp });
+				break;
+			case SDL_MOUSEMOTION:
+				state.mouseX = event.motion.x;
+				state.mouseY = event.motion.y;
+				state.mouseDeltaX += event.motion.xrel;
+				state.mouseDeltaY += event.motion.yrel;
+				break;
+			case SDL_MOUSEBUTTONDOWN:
+			case SDL_MOUSEBUTTONUP:
+				if (event.button.button < MouseButtonNum)
+				{
+					const bool down = event.type == SDL_MOUSEBUTTONDOWN;
+					state.mouseDown[event.button.button] = down;
+					(down ? state.mousePressed : state.mouseReleased)[event.button.button] = true;
+				}
+				publish(Event::InputEvent{ event.type, event.button.button, event.button.x, event.button.y, event.button.timestamp });
+				break;
+			case SDL_MOUSEWHEEL:
+				state.wheelX += event.wheel.x;
+				state.wheelY += event.wheel.y;
+				break;
+			case SDL_CONTROLLERDEVICEADDED:
+				if (controller == nullptr)
+				{
+					controller = SDL_GameControllerOpen(event.cdevice.which);
+				}
+				break;
+			case SDL_CONTROLLERAXISMOTION:
+				if (event.caxis.axis < PadAxisNum)
+				{
+					state.padAxis[event.caxis.axis] = normalizeAxis(event.caxis.value);
+				}
+				break;
+			case SDL_CONTROLLERBUTTONDOWN:
+			case SDL_CONTROLLERBUTTONUP:
+				if (event.cbutton.button < PadButtonNum)
+				{
+					const bool down = event.type == SDL_CONTROLLERBUTTONDOWN;
+					state.padDown[event.cbutton.button] = down;
+					(down ? state.padPressed : state.padReleased)[event.cbutton.button] = true;
+				}
+				break;
+			}
+		}
+		void setKey(const SDL_Scancode scancode, const bool down, const Uint32 timestamp) noexcept
+		{
+			if (static_cast<std::size_t>(scancode) >= KeyNum || state.down[scancode] == down)
+			{
+				return;
+			}
+			state.down[scancode] = down;
+			(down ? state.pressed : state.released)[scancode] = true;
+			transitionTime[scancode] = timestamp;
+			if (mode == Mode::Record)
+			{
+				recordTransitions.push_back({ static_cast<std::uint32_t>(scancode), timestamp });
+			}
+		}
+		//!@brief InputEvent を発行し、記録中なら再生できるように残します
+		void publish(const Event::InputEvent& event) noexcept
+		{
+			Event::EventBus::get().publish(event);
+			if (mode == Mode::Record)
+			{
+				recordEvents.push_back(event);
+			}
+		}
+	private:
+		InputState state;
+		std::array<Uint32, KeyNum> transitionTime{};
+		Uint32 frameStartTime = 0;
+		Mode mode = Mode::Live;
+		std::vector<RecordFrame> record;
+		std::vector<KeyTransition> recordTransitions;
+		std::vector<Event::InputEvent> recordEvents;
+		std::size_t replayIndex = 0;
+		//記録中は記録済みの数、再生中は次に読む位置
+		std::size_t transitionIndex = 0;
+		std::size_t eventIndex = 0;
+		std::unordered_map<std::string, ActionID> actionIDs;
+		std::vector<std::vector<SDL_Scancode>> actionBindings;
+		SDL_GameController* controller = nullptr;
+	};
+}
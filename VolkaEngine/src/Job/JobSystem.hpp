@@ -0,0 +1,163 @@
+//---------------------------------------------------------
+//!@file JobSystem.hpp
+//!@brief ワーカースレッドで小さな処理(ジョブ)を実行します
+//!@author Volka
+//!@date 2018/11/3
+//!@note 待っているスレッドも残っているジョブを実行するので、ジョブの中から待っても止まりません
+//---------------------------------------------------------
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Job
+{
+	//!@class JobCounter
+	//!@brief まだ終わっていないジョブの数(wait() に渡します)
+	class JobCounter final
+	{
+	public:
+		[[nodiscard]] bool isDone() const noexcept
+		{
+			return count.load(std::memory_order_acquire) == 0;
+		}
+	private:
+		friend class JobSystem;
+		std::atomic<int> count{ 0 };
+	};
+
+	//!@class JobSystem
+	//!@brief ジョブのキューと、それを実行するワーカースレッド
+	class JobSystem final
+	{
+	public:
+		//!@param threadNum ワーカーの数(0 ならコア数 - 1)
+		explicit JobSystem(std::size_t threadNum = 0)
+		{
+			if (threadNum == 0)
+			{
+				const std::size_t hardware = std::thread::hardware_concurrency();
+				threadNum = hardware > 1 ? hardware - 1 : 1;
+			}
+			for (std::size_t i = 0; i < threadNum; ++i)
+			{
+				workers.emplace_back([this]() { run(); });
+			}
+		}
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+		~JobSystem()
+		{
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				running = false;
+			}
+			condition.notify_all();
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+		}
+		//!@brief [job]を追加します。終わると[counter]が減ります
+		void submit(JobCounter& counter, std::function<void()> job)
+		{
+			counter.count.fetch_add(1, std::memory_order_relaxed);
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				jobs.push_back({ std::move(job), &counter });
+			}
+			condition.notify_one();
+		}
+		//!@brief [counter]のジョブがすべて終わるまで、他のジョブを実行しながら待ちます
+		void wait(const JobCounter& counter)
+		{
+			while (!counter.isDone())
+			{
+				if (!runOne())
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+		//!@brief [0, count)を[grain]個ずつに分けて[func](begin, end)を並列に実行し、終わるまで待ちます
+		void parallelFor(const std::size_t count, const std::size_t grain, const std::function<void(std::size_t, std::size_t)>& func)
+		{
+			const std::size_t step = std::max<std::size_t>(grain, 1);
+			JobCounter counter;
+			for (std::size_t begin = step; begin < count; begin += step)
+			{
+				const std::size_t end = std::min(begin + step, count);
+				submit(counter, [&func, begin, end]() { func(begin, end); });
+			}
+			func(0, std::min(step, count));
+			wait(counter);
+		}
+		//!@brief ワーカーの数
+		[[nodiscard]] std::size_t getThreadNum() const noexcept
+		{
+			return workers.size();
+		}
+		[[nodiscard]] static JobSystem& get()
+		{
+			static JobSystem jobSystem;
+			return jobSystem;
+		}
+	private:
+		struct Entry
+		{
+			std::function<void()> job;
+			JobCounter* counter;
+		};
+		//!@brief ジョブを1つ実行します
+		//!@return false:ジョブがなかった
+		bool runOne()
+		{
+			Entry entry;
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				if (jobs.empty())
+				{
+					return false;
+				}
+				entry = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			execute(entry);
+			return true;
+		}
+		static void execute(Entry& entry)
+		{
+			entry.job();
+			entry.counter->count.fetch_sub(1, std::memory_order_release);
+		}
+		void run()
+		{
+			for (;;)
+			{
+				Entry entry;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [this]() { return !jobs.empty() || !running; });
+					if (jobs.empty())
+					{
+						return;
+					}
+					entry = std::move(jobs.front());
+					jobs.pop_front();
+				}
+				execute(entry);
+			}
+		}
+	private:
+		std::vector<std::thread> workers;
+		std::deque<Entry> jobs;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool running = true;
+	};
+}
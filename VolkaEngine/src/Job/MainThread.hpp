@@ -0,0 +1,159 @@
+//---------------------------------------------------------
+//!@file MainThread.hpp
+//!@brief メインスレッドでしか行えない処理をためておき、メインスレッドで実行します
+//!@author Volka
+//!@date 2018/11/3
+//!@note SDL2 の描画APIは SDL_Renderer を作ったスレッドでしか使えないので、描画はここを通してメインスレッドで行います
+//!@note runWhile() の間は、ワーカーで動く処理と並行して、ためておいた処理(前のフレームの描画など)を実行します
+//---------------------------------------------------------
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "JobSystem.hpp"
+
+namespace Job
+{
+	//!@class MainThread
+	//!@note 最初に get() したスレッドをメインスレッドとします
+	class MainThread final
+	{
+	public:
+		//1回にためておく処理の数の目安(毎フレームのヒープ確保を避ける)
+		static constexpr std::size_t ReserveTaskNum = 16;
+	public:
+		MainThread(const MainThread&) = delete;
+		MainThread& operator=(const MainThread&) = delete;
+		//!@brief [task]をためておき、次の drain() か runWhile() で実行します
+		void post(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				tasks.emplace_back(std::move(task));
+				++postedCount;
+			}
+			condition.notify_all();
+		}
+		//!@brief [task]をメインスレッドで実行し、終わるまで待ちます
+		//!@brief ためてある処理が先に実行されます
+		//!@note メインスレッドが runWhile() していないときは、呼んだスレッドでそのまま実行します
+		void invoke(const std::function<void()>& task)
+		{
+			if (isMainThread())
+			{
+				drain();
+				task();
+				return;
+			}
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!running)
+			{
+				lock.unlock();
+				task();
+				return;
+			}
+			tasks.emplace_back([&task]() { task(); });
+			const std::uint64_t ticket = ++postedCount;
+			condition.notify_all();
+			condition.wait(lock, [this, ticket]() { return executedCount >= ticket; });
+		}
+		//!@brief ためてある処理をすべて実行します
+		//!@note メインスレッドから呼んでください(実行中の処理から呼ばれたときは何もしません)
+		void drain()
+		{
+			if (draining)
+			{
+				return;
+			}
+			draining = true;
+			for (;;)
+			{
+				{
+					std::lock_guard<std::mutex> guard(mutex);
+					if (tasks.empty())
+					{
+						break;
+					}
+					executing.swap(tasks);
+				}
+				for (auto& task : executing)
+				{
+					task();
+					{
+						std::lock_guard<std::mutex> guard(mutex);
+						++executedCount;
+					}
+					condition.notify_all();
+				}
+				executing.clear();
+			}
+			draining = false;
+		}
+		//!@brief [work]をワーカーで実行し、終わるまでこのスレッドでためてある処理を実行します
+		//!@note メインスレッドから呼んでください
+		void runWhile(const std::function<void()>& work)
+		{
+			auto& jobSystem = JobSystem::get();
+			JobCounter counter;
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				running = true;
+				working = true;
+			}
+			jobSystem.submit(counter, [this, &work]()
+			{
+				work();
+				{
+					std::lock_guard<std::mutex> guard(mutex);
+					working = false;
+				}
+				condition.notify_all();
+			});
+			for (;;)
+			{
+				drain();
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this]() { return !tasks.empty() || !working; });
+				if (tasks.empty())
+				{
+					running = false;
+					break;
+				}
+			}
+			jobSystem.wait(counter);
+		}
+		//!@brief 呼んだスレッドがメインスレッドか
+		[[nodiscard]] bool isMainThread() const noexcept
+		{
+			return std::this_thread::get_id() == mainThreadId;
+		}
+		[[nodiscard]] static MainThread& get()
+		{
+			//描画を持つComponentより後まで残すために解放しない
+			static MainThread* mainThread = new MainThread();
+			return *mainThread;
+		}
+	private:
+		MainThread()
+			: mainThreadId(std::this_thread::get_id())
+		{
+			tasks.reserve(ReserveTaskNum);
+			executing.reserve(ReserveTaskNum);
+		}
+	private:
+		const std::thread::id mainThreadId;
+		std::vector<std::function<void()>> tasks;
+		//drain() で実行中の処理(メインスレッドだけが触る)
+		std::vector<std::function<void()>> executing;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::uint64_t postedCount = 0;
+		std::uint64_t executedCount = 0;
+		bool running = false;
+		bool working = false;
+		bool draining = false;
+	};
+}
@@ -0,0 +1,92 @@
+#include "AllocationHook.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::size_t> totalCount{ 0 };
+	std::atomic<std::size_t> frameCount{ 0 };
+	std::atomic<std::size_t> lastFrameCount{ 0 };
+}
+
+bool Memory::AllocationHook::isEnabled() noexcept
+{
+#ifdef VOLKA_ENABLE_ALLOCATION_HOOK
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::size_t Memory::AllocationHook::getTotalCount() noexcept
+{
+	return totalCount.load(std::memory_order_relaxed);
+}
+
+std::size_t Memory::AllocationHook::getFrameCount() noexcept
+{
+	return frameCount.load(std::memory_order_relaxed);
+}
+
+std::size_t Memory::AllocationHook::getLastFrameCount() noexcept
+{
+	return lastFrameCount.load(std::memory_order_relaxed);
+}
+
+void Memory::AllocationHook::beginFrame() noexcept
+{
+	lastFrameCount.store(frameCount.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+#ifdef VOLKA_ENABLE_ALLOCATION_HOOK
+namespace
+{
+	void* CountedAllocate(const std::size_t size)
+	{
+		totalCount.fetch_add(1, std::memory_order_relaxed);
+		frameCount.fetch_add(1, std::memory_order_relaxed);
+		if (void* ptr = std::malloc(size == 0 ? 1 : size))
+		{
+			return ptr;
+		}
+		throw std::bad_alloc();
+	}
+	void* CountedAllocate(const std::size_t size, const std::align_val_t alignment)
+	{
+		totalCount.fetch_add(1, std::memory_order_relaxed);
+		frameCount.fetch_add(1, std::memory_order_relaxed);
+		const std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+		if (void* ptr = _aligned_malloc(size == 0 ? 1 : size, align))
+#else
+		if (void* ptr = std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align))
+#endif
+		{
+			return ptr;
+		}
+		throw std::bad_alloc();
+	}
+	void CountedFree(void* ptr, const std::align_val_t) noexcept
+	{
+#ifdef _MSC_VER
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+void* operator new(std::size_t size) { return CountedAllocate(size); }
+void* operator new[](std::size_t size) { return CountedAllocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return CountedAllocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return CountedAllocate(size, alignment); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { CountedFree(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { CountedFree(ptr, alignment); }
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept { CountedFree(ptr, alignment); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept { CountedFree(ptr, alignment); }
+#endif
@@ -0,0 +1,29 @@
+//---------------------------------------------------------
+//!@file AllocationHook.hpp
+//!@brief グローバルな new/delete の呼び出し回数を数えます
+//!@author Volka
+//!@date 2018/11/3
+//!@note VOLKA_ENABLE_ALLOCATION_HOOK を定義したときだけ operator new を置き換えます
+//!@note 定常状態のフレームでヒープ確保が 0 回かどうかの確認に使います
+//---------------------------------------------------------
+#pragma once
+#include <cstddef>
+
+namespace Memory
+{
+	//!@class AllocationHook
+	class AllocationHook final
+	{
+	public:
+		//!@brief フックが有効かどうか
+		[[nodiscard]] static bool isEnabled() noexcept;
+		//!@brief 起動してからの確保回数を取得します
+		[[nodiscard]] static std::size_t getTotalCount() noexcept;
+		//!@brief 現在のフレームでの確保回数を取得します
+		[[nodiscard]] static std::size_t getFrameCount() noexcept;
+		//!@brief 1つ前のフレームでの確保回数を取得します
+		[[nodiscard]] static std::size_t getLastFrameCount() noexcept;
+		//!@brief フレームの区切りを通知します
+		static void beginFrame() noexcept;
+	};
+}
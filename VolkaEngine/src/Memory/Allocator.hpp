@@ -0,0 +1,392 @@
+//---------------------------------------------------------
+//!@file Allocator.hpp
+//!@brief エンジンのメモリアロケータ群を用意します
+//!@author Volka
+//!@date 2018/11/3
+//!@note LinearAllocator, FrameAllocator, BlockPool, PoolAllocator など
+//!@note 定常状態のフレームではグローバルヒープを呼ばないことを目標とします
+//---------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <memory_resource>
+#include <mutex>
+#include <type_traits>
+
+namespace Memory
+{
+	//!@brief [value]を[alignment]の倍数に切り上げます
+	constexpr std::size_t AlignUp(const std::size_t value, const std::size_t alignment) noexcept
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	//!@class SpinLock
+	//!@brief 短い区間を守るためのスピンロック(ヒープを使わない)
+	class SpinLock final
+	{
+	public:
+		void lock() noexcept
+		{
+			while (flag.test_and_set(std::memory_order_acquire)) {}
+		}
+		void unlock() noexcept
+		{
+			flag.clear(std::memory_order_release);
+		}
+	private:
+		std::atomic_flag flag = ATOMIC_FLAG_INIT;
+	};
+
+	//!@class LinearAllocator
+	//!@brief 先頭から詰めて確保し、reset()でまとめて解放するアリーナ
+	//!@note std::pmr::memory_resource なので pmr コンテナにそのまま渡せます
+	//!@note 容量を超えた分は上位のリソースから確保し、reset()時に解放します
+	class LinearAllocator final : public std::pmr::memory_resource
+	{
+	public:
+		explicit LinearAllocator(const std::size_t capacityBytes)
+			: buffer(static_cast<std::byte*>(::operator new(capacityBytes))), capacity(capacityBytes)
+		{}
+		LinearAllocator(const LinearAllocator&) = delete;
+		LinearAllocator& operator=(const LinearAllocator&) = delete;
+		virtual ~LinearAllocator()
+		{
+			releaseOverflow();
+			::operator delete(buffer);
+		}
+		//!@brief 確保したメモリをすべて破棄します(デストラクタは呼ばれません)
+		void reset() noexcept
+		{
+			releaseOverflow();
+			offset.store(0, std::memory_order_relaxed);
+		}
+		//!@brief [T]を構築します
+		template<typename T, typename... TArgs> T* create(TArgs&&... args)
+		{
+			return new (allocate(sizeof(T), alignof(T))) T(std::forward<TArgs>(args)...);
+		}
+		//!@brief [T]の配列を確保します(初期化はしません)
+		template<typename T> T* allocateArray(const std::size_t count)
+		{
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+		//!@brief 使用中のバイト数を取得します
+		[[nodiscard]] std::size_t getUsedBytes() const noexcept
+		{
+			const std::size_t used = offset.load(std::memory_order_relaxed);
+			return used < capacity ? used : capacity;
+		}
+		//!@brief 確保できるバイト数を取得します
+		[[nodiscard]] std::size_t getCapacity() const noexcept
+		{
+			return capacity;
+		}
+		//!@brief 容量を超えて上位リソースから確保した回数を取得します
+		[[nodiscard]] std::size_t getOverflowCount() const noexcept
+		{
+			return overflowCount.load(std::memory_order_relaxed);
+		}
+	private:
+		//容量を超えた確保はこのヘッダでつないでおく
+		struct OverflowBlock
+		{
+			OverflowBlock* next;
+			std::size_t alignment;
+		};
+
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			//複数スレッドから確保できるように CAS で進める
+			std::size_t current = offset.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				const std::size_t aligned = AlignUp(current, alignment);
+				const std::size_t next = aligned + bytes;
+				if (next > capacity)
+				{
+					break;
+				}
+				if (offset.compare_exchange_weak(current, next, std::memory_order_relaxed))
+				{
+					return buffer + aligned;
+				}
+			}
+			overflowCount.fetch_add(1, std::memory_order_relaxed);
+			const std::size_t blockAlignment = alignment < alignof(std::max_align_t) ? alignof(std::max_align_t) : alignment;
+			const std::size_t headerSize = AlignUp(sizeof(OverflowBlock), blockAlignment);
+			auto header = static_cast<OverflowBlock*>(::operator new(headerSize + bytes, std::align_val_t(blockAlignment)));
+			header->alignment = blockAlignment;
+			header->next = overflowHead.load(std::memory_order_relaxed);
+			while (!overflowHead.compare_exchange_weak(header->next, header, std::memory_order_release, std::memory_order_relaxed)) {}
+			return reinterpret_cast<std::byte*>(header) + headerSize;
+		}
+		void do_deallocate(void*, std::size_t, std::size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+		void releaseOverflow() noexcept
+		{
+			OverflowBlock* header = overflowHead.exchange(nullptr, std::memory_order_acquire);
+			while (header != nullptr)
+			{
+				OverflowBlock* next = header->next;
+				::operator delete(header, std::align_val_t(header->alignment));
+				header = next;
+			}
+		}
+	private:
+		std::byte* buffer;
+		const std::size_t capacity;
+		std::atomic<std::size_t> offset{ 0 };
+		std::atomic<std::size_t> overflowCount{ 0 };
+		std::atomic<OverflowBlock*> overflowHead{ nullptr };
+	};
+
+	//!@class FrameAllocator
+	//!@brief 1フレームだけ生きる一時データ用のアリーナ
+	//!@note ダブルバッファなので、前フレームのデータは次のフレームの間も有効です
+	//!@note (描画スレッドが前フレームのコマンドを読んでいる間に上書きしないため)
+	class FrameAllocator final
+	{
+	public:
+		static constexpr std::size_t DefaultCapacity = 4 * 1024 * 1024;
+		static constexpr std::size_t BufferNum = 2;
+	public:
+		explicit FrameAllocator(const std::size_t capacityBytes = DefaultCapacity)
+			: arena{ LinearAllocator(capacityBytes), LinearAllocator(capacityBytes) }
+		{}
+		//!@brief フレームの開始時に呼び、古い方のバッファを再利用します
+		void beginFrame() noexcept
+		{
+			current = (current + 1) % BufferNum;
+			arena[current].reset();
+			++frameCount;
+		}
+		//!@brief 現在のフレームのアリーナを取得します
+		[[nodiscard]] LinearAllocator& getArena() noexcept
+		{
+			return arena[current];
+		}
+		//!@brief 1つ前のフレームのアリーナを取得します
+		[[nodiscard]] LinearAllocator& getPreviousArena() noexcept
+		{
+			return arena[(current + BufferNum - 1) % BufferNum];
+		}
+		//!@brief pmr コンテナに渡すためのリソースを取得します
+		[[nodiscard]] std::pmr::memory_resource* getResource() noexcept
+		{
+			return &arena[current];
+		}
+		//!@brief 経過フレーム数を取得します
+		[[nodiscard]] std::uint64_t getFrameCount() const noexcept
+		{
+			return frameCount;
+		}
+		[[nodiscard]] static FrameAllocator& get() noexcept
+		{
+			static FrameAllocator frameAllocator;
+			return frameAllocator;
+		}
+	private:
+		std::array<LinearAllocator, BufferNum> arena;
+		std::size_t current = 0;
+		std::uint64_t frameCount = 0;
+	};
+
+	//!@brief フレーム内だけで使う vector
+	template<typename T> using FrameVector = std::pmr::vector<T>;
+
+	//!@class BlockPool
+	//!@brief 固定サイズのブロックをフリーリストで使い回すプール
+	//!@note チャンク単位でまとめて確保するので、定常状態ではヒープを呼びません
+	class BlockPool final
+	{
+	public:
+		static constexpr std::size_t DefaultBlocksPerChunk = 256;
+	public:
+		explicit BlockPool(const std::size_t size = sizeof(void*), const std::size_t blocksPerChunk = DefaultBlocksPerChunk) noexcept
+			: blockSize(AlignUp(size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size, alignof(std::max_align_t))),
+			chunkBlockNum(blocksPerChunk)
+		{}
+		BlockPool(const BlockPool&) = delete;
+		BlockPool& operator=(const BlockPool&) = delete;
+		~BlockPool()
+		{
+			while (chunkHead != nullptr)
+			{
+				Chunk* next = chunkHead->next;
+				::operator delete(chunkHead);
+				chunkHead = next;
+			}
+		}
+		//!@brief ブロックを1つ確保します
+		[[nodiscard]] void* allocate()
+		{
+			std::lock_guard<SpinLock> guard(lock);
+			if (freeHead == nullptr)
+			{
+				addChunk(chunkBlockNum);
+			}
+			FreeBlock* block = freeHead;
+			freeHead = block->next;
+			++usedNum;
+			return block;
+		}
+		//!@brief ブロックをプールに返します
+		void deallocate(void* ptr) noexcept
+		{
+			if (ptr == nullptr)
+			{
+				return;
+			}
+			std::lock_guard<SpinLock> guard(lock);
+			auto block = static_cast<FreeBlock*>(ptr);
+			block->next = freeHead;
+			freeHead = block;
+			--usedNum;
+		}
+		//!@brief [count]個分のブロックを1回の確保で用意しておきます
+		void reserve(const std::size_t count)
+		{
+			std::lock_guard<SpinLock> guard(lock);
+			const std::size_t freeNum = blockNum - usedNum;
+			if (count > freeNum)
+			{
+				addChunk(count - freeNum);
+			}
+		}
+		[[nodiscard]] std::size_t getBlockSize() const noexcept { return blockSize; }
+		[[nodiscard]] std::size_t getUsedNum() const noexcept { return usedNum; }
+		[[nodiscard]] std::size_t getBlockNum() const noexcept { return blockNum; }
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+		struct Chunk
+		{
+			Chunk* next;
+		};
+		static constexpr std::size_t ChunkHeaderSize = AlignUp(sizeof(Chunk), alignof(std::max_align_t));
+		void addChunk(const std::size_t count)
+		{
+			auto memory = static_cast<std::byte*>(::operator new(ChunkHeaderSize + blockSize * count));
+			auto chunk = reinterpret_cast<Chunk*>(memory);
+			chunk->next = chunkHead;
+			chunkHead = chunk;
+			//先頭のブロックから順に取り出されるように逆順でつなぐ
+			for (std::size_t i = count; i > 0; --i)
+			{
+				auto block = reinterpret_cast<FreeBlock*>(memory + ChunkHeaderSize + blockSize * (i - 1));
+				block->next = freeHead;
+				freeHead = block;
+			}
+			blockNum += count;
+		}
+	private:
+		const std::size_t blockSize;
+		const std::size_t chunkBlockNum;
+		FreeBlock* freeHead = nullptr;
+		Chunk* chunkHead = nullptr;
+		std::size_t usedNum = 0;
+		std::size_t blockNum = 0;
+		SpinLock lock;
+	};
+
+	//!@class PoolAllocator
+	//!@brief サイズクラスごとの BlockPool をまとめたアロケータ
+	//!@note Component と Entity の new はここを通ります
+	//!@note MaxPoolSize を超えるものは通常のヒープから確保します
+	class PoolAllocator final
+	{
+	public:
+		static constexpr std::size_t SizeClassStep = alignof(std::max_align_t);
+		static constexpr std::size_t MaxPoolSize = 1024;
+		static constexpr std::size_t SizeClassNum = MaxPoolSize / SizeClassStep;
+	public:
+		PoolAllocator()
+		{
+			for (std::size_t i = 0; i < SizeClassNum; ++i)
+			{
+				new (&pools[i]) BlockPool((i + 1) * SizeClassStep);
+			}
+		}
+		~PoolAllocator()
+		{
+			for (auto& pool : pools)
+			{
+				reinterpret_cast<BlockPool*>(&pool)->~BlockPool();
+			}
+		}
+		//!@brief [size]バイトを確保します
+		[[nodiscard]] void* allocate(const std::size_t size)
+		{
+			if (size == 0 || size > MaxPoolSize)
+			{
+				return ::operator new(size);
+			}
+			return getPool(size).allocate();
+		}
+		//!@brief [size]バイトで確保したメモリを返します
+		void deallocate(void* ptr, const std::size_t size) noexcept
+		{
+			if (size == 0 || size > MaxPoolSize)
+			{
+				::operator delete(ptr);
+				return;
+			}
+			getPool(size).deallocate(ptr);
+		}
+		//!@brief [size]バイトのブロックを[count]個分先に確保しておきます
+		void reserve(const std::size_t size, const std::size_t count)
+		{
+			if (size == 0 || size > MaxPoolSize)
+			{
+				return;
+			}
+			getPool(size).reserve(count);
+		}
+		//!@brief [size]バイトを扱うプールを取得します
+		[[nodiscard]] BlockPool& getPool(const std::size_t size) noexcept
+		{
+			return *reinterpret_cast<BlockPool*>(&pools[(size - 1) / SizeClassStep]);
+		}
+		//!@brief 終了時に Entity 等の解放が終わる前に破棄されないように、意図的に解放しません
+		[[nodiscard]] static PoolAllocator& get() noexcept
+		{
+			static PoolAllocator* poolAllocator = new PoolAllocator();
+			return *poolAllocator;
+		}
+	private:
+		using PoolStorage = std::aligned_storage_t<sizeof(BlockPool), alignof(BlockPool)>;
+		std::array<PoolStorage, SizeClassNum> pools;
+	};
+
+	//!@class PoolStdAllocator
+	//!@brief PoolAllocator を STL コンテナから使うためのアダプタ
+	template<typename T>
+	class PoolStdAllocator
+	{
+	public:
+		using value_type = T;
+	public:
+		PoolStdAllocator() noexcept = default;
+		template<typename U> PoolStdAllocator(const PoolStdAllocator<U>&) noexcept {}
+		[[nodiscard]] T* allocate(const std::size_t n)
+		{
+			return static_cast<T*>(PoolAllocator::get().allocate(sizeof(T) * n));
+		}
+		void deallocate(T* ptr, const std::size_t n) noexcept
+		{
+			PoolAllocator::get().deallocate(ptr, sizeof(T) * n);
+		}
+		template<typename U> bool operator==(const PoolStdAllocator<U>&) const noexcept { return true; }
+		template<typename U> bool operator!=(const PoolStdAllocator<U>&) const noexcept { return false; }
+	};
+}
@@ -0,0 +1,214 @@
+//---------------------------------------------------------
+//!@file MemoryTracker.hpp
+//!@brief Componentの型ごと、EntityManagerごとのメモリ使用量を記録します
+//!@author Volka
+//!@date 2018/11/3
+//!@note カウンタは relaxed な atomic だけなので、製品版でも有効のままにできます
+//---------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include "AllocationHook.hpp"
+
+namespace Memory
+{
+	//!@class MemoryStats
+	//!@brief ある時点でのカウンタの値
+	struct MemoryStats
+	{
+		std::int64_t currentBytes = 0;
+		std::int64_t peakBytes = 0;
+		std::uint64_t allocCount = 0;
+		std::uint64_t freeCount = 0;
+		std::uint64_t frameAllocCount = 0;
+		std::uint64_t lastFrameAllocCount = 0;
+	};
+
+	//!@class MemoryCounter
+	//!@brief 現在/最大のバイト数と確保回数を数えます
+	class MemoryCounter final
+	{
+	public:
+		//!@brief [bytes]の確保を記録します
+		void onAllocate(const std::size_t bytes) noexcept
+		{
+			const std::int64_t now = currentBytes.fetch_add(static_cast<std::int64_t>(bytes), std::memory_order_relaxed) + static_cast<std::int64_t>(bytes);
+			std::int64_t peak = peakBytes.load(std::memory_order_relaxed);
+			while (now > peak && !peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+			allocCount.fetch_add(1, std::memory_order_relaxed);
+			frameAllocCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		//!@brief [bytes]の解放を記録します
+		void onFree(const std::size_t bytes) noexcept
+		{
+			currentBytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+			freeCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		//!@brief フレームの区切りでフレーム内の確保回数を繰り越します
+		void beginFrame() noexcept
+		{
+			lastFrameAllocCount.store(frameAllocCount.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		//!@brief 現在の値を取得します
+		[[nodiscard]] MemoryStats getStats() const noexcept
+		{
+			MemoryStats stats;
+			stats.currentBytes = currentBytes.load(std::memory_order_relaxed);
+			stats.peakBytes = peakBytes.load(std::memory_order_relaxed);
+			stats.allocCount = allocCount.load(std::memory_order_relaxed);
+			stats.freeCount = freeCount.load(std::memory_order_relaxed);
+			stats.frameAllocCount = frameAllocCount.load(std::memory_order_relaxed);
+			stats.lastFrameAllocCount = lastFrameAllocCount.load(std::memory_order_relaxed);
+			return stats;
+		}
+	private:
+		std::atomic<std::int64_t> currentBytes{ 0 };
+		std::atomic<std::int64_t> peakBytes{ 0 };
+		std::atomic<std::uint64_t> allocCount{ 0 };
+		std::atomic<std::uint64_t> freeCount{ 0 };
+		std::atomic<std::uint64_t> frameAllocCount{ 0 };
+		std::atomic<std::uint64_t> lastFrameAllocCount{ 0 };
+	};
+
+	//!@class MemoryTracker
+	//!@brief 型IDごとのカウンタと、名前付きのカウンタ(EntityManager)を管理します
+	class MemoryTracker final
+	{
+	public:
+		//ECS::MaxComponents と合わせる
+		static constexpr std::size_t MaxTypes = 64;
+	public:
+		//!@brief 型IDに名前とサイズを登録します
+		void registType(const std::size_t typeID, const std::string& name, const std::size_t size)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			typeNames[typeID] = name;
+			typeSizes[typeID] = size;
+		}
+		//!@brief 型IDに登録したサイズを取得します
+		[[nodiscard]] std::size_t getTypeSize(const std::size_t typeID) const noexcept
+		{
+			return typeSizes[typeID];
+		}
+		//!@brief 型IDのカウンタを取得します
+		[[nodiscard]] MemoryCounter& getTypeCounter(const std::size_t typeID) noexcept
+		{
+			return typeCounters[typeID];
+		}
+		//!@brief 型IDのカウンタの値を取得します
+		[[nodiscard]] MemoryStats getTypeStats(const std::size_t typeID) const noexcept
+		{
+			return typeCounters[typeID].getStats();
+		}
+		//!@brief 名前付きのカウンタを登録します(カウンタの寿命は呼び出し側で管理)
+		void registCounter(const std::string& name, MemoryCounter& counter)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			namedCounters[name] = &counter;
+		}
+		//!@brief 名前付きのカウンタの登録を解除します
+		void removeCounter(const std::string& name)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			namedCounters.erase(name);
+		}
+		//!@brief 名前付きのカウンタの値を取得します(未登録なら空の値)
+		[[nodiscard]] MemoryStats getStats(const std::string& name) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			const auto itr = namedCounters.find(name);
+			if (itr == namedCounters.end())
+			{
+				return MemoryStats();
+			}
+			return itr->second->getStats();
+		}
+		//!@brief [frameInterval]フレームごとに[filePath]へ書き出します(0で無効)
+		void setDumpInterval(const std::uint64_t frameInterval, const std::string& filePath)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			dumpInterval = frameInterval;
+			dumpPath = filePath;
+		}
+		//!@brief フレームの区切りを通知します
+		//!@brief フレーム内の確保回数を繰り越し、必要なら書き出します
+		void beginFrame()
+		{
+			for (auto& counter : typeCounters)
+			{
+				counter.beginFrame();
+			}
+			std::lock_guard<std::mutex> guard(mutex);
+			for (auto& counter : namedCounters)
+			{
+				counter.second->beginFrame();
+			}
+			++frameCount;
+			if (dumpInterval != 0 && frameCount % dumpInterval == 0)
+			{
+				std::ofstream file(dumpPath, std::ios::app);
+				if (file)
+				{
+					dumpUnlocked(file);
+				}
+			}
+		}
+		//!@brief 全カウンタを書き出します
+		void dump(std::ostream& os) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			dumpUnlocked(os);
+		}
+		//!@brief 終了時のEntityの解放も記録できるように、意図的に解放しません
+		[[nodiscard]] static MemoryTracker& get() noexcept
+		{
+			static MemoryTracker* memoryTracker = new MemoryTracker();
+			return *memoryTracker;
+		}
+	private:
+		static void dumpLine(std::ostream& os, const std::string& label, const MemoryStats& stats)
+		{
+			os << label
+				<< " current=" << stats.currentBytes
+				<< " peak=" << stats.peakBytes
+				<< " alloc=" << stats.allocCount
+				<< " free=" << stats.freeCount
+				<< " frameAlloc=" << stats.lastFrameAllocCount << "\n";
+		}
+		void dumpUnlocked(std::ostream& os) const
+		{
+			os << "[memory] frame=" << frameCount
+				<< " heapAlloc(lastFrame)=" << AllocationHook::getLastFrameCount()
+				<< " heapAlloc(total)=" << AllocationHook::getTotalCount() << "\n";
+			for (const auto& counter : namedCounters)
+			{
+				dumpLine(os, "  manager:" + counter.first, counter.second->getStats());
+			}
+			for (const auto& type : typeNames)
+			{
+				const MemoryStats stats = typeCounters[type.first].getStats();
+				if (stats.allocCount == 0)
+				{
+					continue;
+				}
+				dumpLine(os, "  component:" + type.second, stats);
+			}
+			os.flush();
+		}
+	private:
+		std::array<MemoryCounter, MaxTypes> typeCounters;
+		std::array<std::size_t, MaxTypes> typeSizes{};
+		std::map<std::size_t, std::string> typeNames;
+		std::map<std::string, MemoryCounter*> namedCounters;
+		std::uint64_t frameCount = 0;
+		std::uint64_t dumpInterval = 0;
+		std::string dumpPath;
+		mutable std::mutex mutex;
+	};
+}
@@ -0,0 +1,221 @@
+//---------------------------------------------------------
+//!@file BitmapFont.hpp
+//!@brief グリフを1枚の texture にまとめたフォントと、文字列の並べ方のキャッシュ
+//!@author Volka
+//!@date 2018/11/3
+//!@note 格子状に並んだフォント画像か、VOLKA_USE_SDL_TTF を定義したときは TTF から作ります
+//!@note 同じ文字列の並べ方(頂点)は使い回すので、変わらない文字列は毎フレーム計算しません
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef VOLKA_USE_SDL_TTF
+#include <SDL2_ttf/SDL_ttf.h>
+#pragma comment(lib, "SDL2_ttf.lib")
+#endif
+
+namespace Render
+{
+	//!@class Glyph
+	//!@brief 1文字の texture 上の位置と送り幅
+	struct Glyph
+	{
+		SDL_Rect src = { 0, 0, 0, 0 };
+		int advance = 0;
+		bool valid = false;
+	};
+
+	//!@class TextRun
+	//!@brief 並べ終わった文字列(左上が原点、白)
+	struct TextRun
+	{
+		std::vector<SDL_Vertex> vertices;
+		int width = 0;
+		int height = 0;
+	};
+
+	//!@class BitmapFont
+	class BitmapFont final
+	{
+	public:
+		//キャッシュする文字列の数(超えたら空にします)
+		static constexpr std::size_t MaxCacheNum = 256;
+	public:
+		BitmapFont(const BitmapFont&) = delete;
+		BitmapFont& operator=(const BitmapFont&) = delete;
+		~BitmapFont()
+		{
+			if (ownTexture && texture != nullptr)
+			{
+				SDL_DestroyTexture(texture);
+			}
+		}
+		//!@brief [cellWidth]x[cellHeight]の格子に[columns]列で並んだフォント画像から作ります
+		//!@param firstChar 左上の文字
+		//!@param glyphNum 並んでいる文字数
+		static std::shared_ptr<BitmapFont> createFromGrid(SDL_Texture* fontTexture, const int cellWidth, const int cellHeight,
+			const int columns, const unsigned char firstChar = ' ', const int glyphNum = 95)
+		{
+			std::shared_ptr<BitmapFont> font(new BitmapFont());
+			font->texture = fontTexture;
+			font->lineHeight = cellHeight;
+			SDL_QueryTexture(fontTexture, nullptr, nullptr, &font->textureWidth, &font->textureHeight);
+			for (int i = 0; i < glyphNum && firstChar + i < 256; ++i)
+			{
+				Glyph& glyph = font->glyphs[firstChar + i];
+				glyph.src = { (i % columns) * cellWidth, (i / columns) * cellHeight, cellWidth, cellHeight };
+				glyph.advance = cellWidth;
+				glyph.valid = true;
+			}
+			return font;
+		}
+#ifdef VOLKA_USE_SDL_TTF
+		//!@brief TTF の ASCII(' '～'~')を1枚の texture に描いて作ります
+		//!@note texture を作るので、フレームの途中では RendererSystem::invoke() の中で呼んでください
+		static std::shared_ptr<BitmapFont> createFromTTF(SDL_Renderer* renderer, const std::string& filePath, const int pointSize)
+		{
+			if (TTF_WasInit() == 0 && TTF_Init() != 0)
+			{
+				return nullptr;
+			}
+			TTF_Font* ttf = TTF_OpenFont(filePath.c_str(), pointSize);
+			if (ttf == nullptr)
+			{
+				return nullptr;
+			}
+			std::shared_ptr<BitmapFont> font(new BitmapFont());
+			font->lineHeight = TTF_FontLineSkip(ttf);
+			const int atlasWidth = 512;
+			const SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+			//先に位置を決めてから1枚の surface に描く
+			std::vector<SDL_Surface*> surfaces;
+			int x = 0, y = 0, rowHeight = 0;
+			for (int c = ' '; c <= '~'; ++c)
+			{
+				SDL_Surface* glyphSurface = TTF_RenderGlyph_Blended(ttf, static_cast<Uint16>(c), white);
+				surfaces.push_back(glyphSurface);
+				if (glyphSurface == nullptr)
+				{
+					continue;
+				}
+				if (x + glyphSurface->w > atlasWidth)
+				{
+					x = 0;
+					y += rowHeight + 1;
+					rowHeight = 0;
+				}
+				Glyph& glyph = font->glyphs[c];
+				glyph.src = { x, y, glyphSurface->w, glyphSurface->h };
+				TTF_GlyphMetrics(ttf, static_cast<Uint16>(c), nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+				glyph.valid = true;
+				x += glyphSurface->w + 1;
+				rowHeight = std::max(rowHeight, glyphSurface->h);
+			}
+			SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, y + rowHeight, 32, SDL_PIXELFORMAT_RGBA32);
+			for (int c = ' '; c <= '~'; ++c)
+			{
+				SDL_Surface* glyphSurface = surfaces[c - ' '];
+				if (glyphSurface == nullptr)
+				{
+					continue;
+				}
+				SDL_SetSurfaceBlendMode(glyphSurface, SDL_BLENDMODE_NONE);
+				SDL_Rect dst = font->glyphs[c].src;
+				SDL_BlitSurface(glyphSurface, nullptr, atlas, &dst);
+				SDL_FreeSurface(glyphSurface);
+			}
+			TTF_CloseFont(ttf);
+			font->texture = SDL_CreateTextureFromSurface(renderer, atlas);
+			font->ownTexture = true;
+			font->textureWidth = atlas->w;
+			font->textureHeight = atlas->h;
+			SDL_FreeSurface(atlas);
+			SDL_SetTextureBlendMode(font->texture, SDL_BLENDMODE_BLEND);
+			return font;
+		}
+#endif
+		//!@brief [text]を並べた頂点を取得します(同じ文字列は前の結果を返します)
+		[[nodiscard]] std::shared_ptr<const TextRun> shape(const std::string& text)
+		{
+			const auto itr = cache.find(text);
+			if (itr != cache.end())
+			{
+				return itr->second;
+			}
+			if (cache.size() >= MaxCacheNum)
+			{
+				cache.clear();
+			}
+			auto run = std::make_shared<TextRun>();
+			run->vertices.reserve(text.size() * 6);
+			const float invW = 1.0f / static_cast<float>(textureWidth);
+			const float invH = 1.0f / static_cast<float>(textureHeight);
+			const SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+			int x = 0;
+			int y = 0;
+			for (const char ch : text)
+			{
+				if (ch == '\n')
+				{
+					x = 0;
+					y += lineHeight;
+					continue;
+				}
+				const Glyph& glyph = glyphs[static_cast<unsigned char>(ch)];
+				if (!glyph.valid)
+				{
+					continue;
+				}
+				const float left = static_cast<float>(x);
+				const float top = static_cast<float>(y);
+				const float right = left + glyph.src.w;
+				const float bottom = top + glyph.src.h;
+				const float u0 = glyph.src.x * invW;
+				const float v0 = glyph.src.y * invH;
+				const float u1 = (glyph.src.x + glyph.src.w) * invW;
+				const float v1 = (glyph.src.y + glyph.src.h) * invH;
+				run->vertices.push_back({ { left, top }, white, { u0, v0 } });
+				run->vertices.push_back({ { right, top }, white, { u1, v0 } });
+				run->vertices.push_back({ { left, bottom }, white, { u0, v1 } });
+				run->vertices.push_back({ { right, top }, white, { u1, v0 } });
+				run->vertices.push_back({ { right, bottom }, white, { u1, v1 } });
+				run->vertices.push_back({ { left, bottom }, white, { u0, v1 } });
+				x += glyph.advance;
+				run->width = std::max(run->width, x);
+			}
+			run->height = y + lineHeight;
+			cache.emplace(text, run);
+			return run;
+		}
+		//!@brief フォントの texture
+		[[nodiscard]] SDL_Texture* getTexture() const noexcept
+		{
+			return texture;
+		}
+		//!@brief 1行の高さ
+		[[nodiscard]] int getLineHeight() const noexcept
+		{
+			return lineHeight;
+		}
+		//!@brief [ch]のグリフ
+		[[nodiscard]] const Glyph& getGlyph(const unsigned char ch) const noexcept
+		{
+			return glyphs[ch];
+		}
+	private:
+		BitmapFont() = default;
+	private:
+		std::array<Glyph, 256> glyphs;
+		std::unordered_map<std::string, std::shared_ptr<const TextRun>> cache;
+		SDL_Texture* texture = nullptr;
+		bool ownTexture = false;
+		int textureWidth = 1;
+		int textureHeight = 1;
+		int lineHeight = 0;
+	};
+}
@@ -0,0 +1,164 @@
+//---------------------------------------------------------
+//!@file Camera.hpp
+//!@brief 2Dカメラのワールド座標からスクリーン座標への変換
+//!@author Volka
+//!@date 2018/11/3
+//!@note 変換はコマンドをリストに積むときに1回だけ行うので、カメラを動かしてもEntityは書き換えません
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include "RenderCommand.hpp"
+
+namespace Render
+{
+	//!@class CameraView
+	//!@brief [position]を[viewport]の中心に映すカメラ
+	//!@note 回転は度数法で、SDL の回転と同じく時計回りが正です
+	struct CameraView
+	{
+		SDL_Rect viewport = { 0, 0, 0, 0 };
+		float positionX = 0.0f;
+		float positionY = 0.0f;
+		float zoom = 1.0f;
+		float rotation = 0.0f;
+		int order = 0;	//小さいものから描画します
+
+		//!@brief ワールド座標をビューポート内の座標へ変換します
+		SDL_FPoint worldToScreen(const float x, const float y) const noexcept
+		{
+			const float radian = -rotation * Pi / 180.0f;
+			const float c = std::cos(radian);
+			const float s = std::sin(radian);
+			const float dx = x - positionX;
+			const float dy = y - positionY;
+			return { (dx * c - dy * s) * zoom + viewport.w * 0.5f, (dx * s + dy * c) * zoom + viewport.h * 0.5f };
+		}
+		//!@brief ビューポート内の座標をワールド座標へ変換します
+		SDL_FPoint screenToWorld(const float x, const float y) const noexcept
+		{
+			const float radian = rotation * Pi / 180.0f;
+			const float c = std::cos(radian);
+			const float s = std::sin(radian);
+			const float dx = (x - viewport.w * 0.5f) / zoom;
+			const float dy = (y - viewport.h * 0.5f) / zoom;
+			return { dx * c - dy * s + positionX, dx * s + dy * c + positionY };
+		}
+		//!@brief カメラに映るワールド座標の範囲(回転しているときは外接する矩形)
+		SDL_Rect getWorldBounds() const noexcept
+		{
+			const SDL_FPoint corners[4] =
+			{
+				screenToWorld(0.0f, 0.0f),
+				screenToWorld(static_cast<float>(viewport.w), 0.0f),
+				screenToWorld(0.0f, static_cast<float>(viewport.h)),
+				screenToWorld(static_cast<float>(viewport.w), static_cast<float>(viewport.h)),
+			};
+			return boundsOf(corners);
+		}
+		//!@brief [count]個の頂点の位置をワールド座標からビューポート内の座標へ変換します
+		void transformVertices(SDL_Vertex* vertices, const std::size_t count) const noexcept
+		{
+			const float radian = -rotation * Pi / 180.0f;
+			const float c = std::cos(radian) * zoom;
+			const float s = std::sin(radian) * zoom;
+			const float halfW = viewport.w * 0.5f;
+			const float halfH = viewport.h * 0.5f;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const float dx = vertices[i].position.x - positionX;
+				const float dy = vertices[i].position.y - positionY;
+				vertices[i].position.x = dx * c - dy * s + halfW;
+				vertices[i].position.y = dx * s + dy * c + halfH;
+			}
+		}
+	private:
+		//!@brief 4点に外接する矩形
+		static SDL_Rect boundsOf(const SDL_FPoint (&corners)[4]) noexcept
+		{
+			float minX = corners[0].x, maxX = corners[0].x, minY = corners[0].y, maxY = corners[0].y;
+			for (const auto& corner : corners)
+			{
+				minX = std::min(minX, corner.x);
+				maxX = std::max(maxX, corner.x);
+				minY = std::min(minY, corner.y);
+				maxY = std::max(maxY, corner.y);
+			}
+			const int x = static_cast<int>(std::floor(minX));
+			const int y = static_cast<int>(std::floor(minY));
+			return { x, y, static_cast<int>(std::ceil(maxX)) - x + 1, static_cast<int>(std::ceil(maxY)) - y + 1 };
+		}
+	public:
+		//!@brief ワールド座標の[command]をこのカメラで見たコマンドにします
+		//!@note 矩形の塗りつぶし/枠は SDL で回転できないので、位置と拡大だけを反映します
+		RenderCommand transform(const RenderCommand& command) const noexcept
+		{
+			RenderCommand result = command;
+			switch (command.type)
+			{
+			case CommandType::Copy:
+			{
+				//ピボットの位置を変換し、そこを中心にカメラの回転を足す
+				const SDL_FPoint pivot = worldToScreen(
+					static_cast<float>(command.dst.x + command.pivot.x), static_cast<float>(command.dst.y + command.pivot.y));
+				result.pivot.x = static_cast<int>(std::lround(command.pivot.x * zoom));
+				result.pivot.y = static_cast<int>(std::lround(command.pivot.y * zoom));
+				result.dst.w = static_cast<int>(std::lround(command.dst.w * zoom));
+				result.dst.h = static_cast<int>(std::lround(command.dst.h * zoom));
+				result.dst.x = static_cast<int>(std::lround(pivot.x)) - result.pivot.x;
+				result.dst.y = static_cast<int>(std::lround(pivot.y)) - result.pivot.y;
+				if (rotation != 0.0f)
+				{
+					result.useRotation = true;
+					result.angle = command.angle - rotation;
+				}
+				break;
+			}
+			case CommandType::Geometry:
+			{
+				//頂点は transformVertices() で変換する。範囲は外接する矩形にする
+				const SDL_FPoint corners[4] =
+				{
+					worldToScreen(static_cast<float>(command.dst.x), static_cast<float>(command.dst.y)),
+					worldToScreen(static_cast<float>(command.dst.x + command.dst.w), static_cast<float>(command.dst.y)),
+					worldToScreen(static_cast<float>(command.dst.x), static_cast<float>(command.dst.y + command.dst.h)),
+					worldToScreen(static_cast<float>(command.dst.x + command.dst.w), static_cast<float>(command.dst.y + command.dst.h)),
+				};
+				result.dst = boundsOf(corners);
+				break;
+			}
+			case CommandType::FillRect:
+			case CommandType::DrawRect:
+			{
+				const SDL_FPoint center = worldToScreen(command.dst.x + command.dst.w * 0.5f, command.dst.y + command.dst.h * 0.5f);
+				result.dst.w = static_cast<int>(std::lround(command.dst.w * zoom));
+				result.dst.h = static_cast<int>(std::lround(command.dst.h * zoom));
+				result.dst.x = static_cast<int>(std::lround(center.x - result.dst.w * 0.5f));
+				result.dst.y = static_cast<int>(std::lround(center.y - result.dst.h * 0.5f));
+				break;
+			}
+			case CommandType::DrawLine:
+			{
+				const SDL_FPoint begin = worldToScreen(static_cast<float>(command.dst.x), static_cast<float>(command.dst.y));
+				const SDL_FPoint end = worldToScreen(static_cast<float>(command.dst.w), static_cast<float>(command.dst.h));
+				result.dst = { static_cast<int>(std::lround(begin.x)), static_cast<int>(std::lround(begin.y)),
+					static_cast<int>(std::lround(end.x)), static_cast<int>(std::lround(end.y)) };
+				break;
+			}
+			case CommandType::DrawPoint:
+			{
+				const SDL_FPoint point = worldToScreen(static_cast<float>(command.dst.x), static_cast<float>(command.dst.y));
+				result.dst.x = static_cast<int>(std::lround(point.x));
+				result.dst.y = static_cast<int>(std::lround(point.y));
+				break;
+			}
+			default:
+				break;
+			}
+			return result;
+		}
+	private:
+		static constexpr float Pi = 3.14159265358979f;
+	};
+}
@@ -0,0 +1,222 @@
+//---------------------------------------------------------
+//!@file DirtyRegion.hpp
+//!@brief 前のフレームと描画内容が変わったスクリーンの領域を求めます
+//!@author Volka
+//!@date 2018/11/3
+//!@note スクリーンをタイルに分け、タイルに重なるコマンドのハッシュを比べます
+//!@note 移動・アニメーション・Alpha値の変化はすべてコマンドの値の変化として見つかります
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "RenderCommand.hpp"
+#include "SpatialGrid.hpp"
+
+namespace Render
+{
+	//!@class DirtyRegionTracker
+	class DirtyRegionTracker final
+	{
+	public:
+		static constexpr int DefaultTileSize = 64;
+		//矩形がこれより多くなるときは、まとめて1つの矩形にします
+		static constexpr std::size_t MaxRectNum = 32;
+	public:
+		//!@brief スクリーンの大きさを設定します(次のフレームは全体を描き直します)
+		void resize(const int width, const int height, const int size = DefaultTileSize)
+		{
+			screenWidth = width;
+			screenHeight = height;
+			tileSize = size > 0 ? size : DefaultTileSize;
+			tileX = (width + tileSize - 1) / tileSize;
+			tileY = (height + tileSize - 1) / tileSize;
+			previous.assign(static_cast<std::size_t>(tileX) * tileY, 0);
+			current.assign(previous.size(), 0);
+			//1行の矩形はタイルの数を超えないので、毎フレームの作業用の配列はここで確保しておく
+			spans.reserve(tileX);
+			openRects.reserve(tileX);
+			nextOpenRects.reserve(tileX);
+			invalidate();
+		}
+		//!@brief 次のフレームはスクリーン全体を描き直します(textureの中身を書き換えたときなど)
+		void invalidate() noexcept
+		{
+			fullRedraw = true;
+		}
+		//!@brief スクリーン座標のコマンド列[begin, end)を前のフレームと比べ、描き直す矩形を[rects]に出します
+		//!@param clearColor 背景色(変わったら全体を描き直します)
+		void update(const RenderCommand* begin, const RenderCommand* end, const SDL_Color& clearColor, std::vector<SDL_Rect>& rects)
+		{
+			rects.clear();
+			std::fill(current.begin(), current.end(), Seed);
+			const SDL_Rect screen = { 0, 0, screenWidth, screenHeight };
+			SDL_Rect viewport = screen;
+			for (const RenderCommand* command = begin; command != end; ++command)
+			{
+				if (command->type == CommandType::Viewport)
+				{
+					viewport = command->dst;
+					continue;
+				}
+				SDL_Rect bounds = GetCommandBounds(*command);
+				if (bounds.w <= 0 || bounds.h <= 0)
+				{
+					continue;
+				}
+				bounds.x += viewport.x;
+				bounds.y += viewport.y;
+				if (!IsOverlap(bounds, screen))
+				{
+					continue;
+				}
+				const std::uint64_t hash = hashCommand(*command, viewport);
+				const int x0 = std::max(bounds.x / tileSize, 0);
+				const int y0 = std::max(bounds.y / tileSize, 0);
+				const int x1 = std::min((bounds.x + bounds.w - 1) / tileSize, tileX - 1);
+				const int y1 = std::min((bounds.y + bounds.h - 1) / tileSize, tileY - 1);
+				for (int y = y0; y <= y1; ++y)
+				{
+					for (int x = x0; x <= x1; ++x)
+					{
+						std::uint64_t& tile = current[static_cast<std::size_t>(y) * tileX + x];
+						tile = (tile ^ hash) * Prime;
+					}
+				}
+			}
+			const std::uint32_t clear = static_cast<std::uint32_t>(clearColor.r) | (clearColor.g << 8) | (clearColor.b << 16) | (static_cast<std::uint32_t>(clearColor.a) << 24);
+			if (clear != lastClearColor)
+			{
+				lastClearColor = clear;
+				fullRedraw = true;
+			}
+			dirtyTileNum = 0;
+			if (fullRedraw)
+			{
+				rects.push_back({ 0, 0, screenWidth, screenHeight });
+				dirtyTileNum = current.size();
+				fullRedraw = false;
+			}
+			else
+			{
+				collectRects(rects);
+			}
+			previous.swap(current);
+		}
+		//!@brief 直前のフレームで描き直したタイルの割合
+		[[nodiscard]] float getDirtyRatio() const noexcept
+		{
+			return previous.empty() ? 0.0f : static_cast<float>(dirtyTileNum) / static_cast<float>(previous.size());
+		}
+	private:
+		//!@brief 変わったタイルを横に繋ぎ、前の行と同じ範囲の矩形は縦にも繋ぎます
+		void collectRects(std::vector<SDL_Rect>& rects)
+		{
+			openRects.clear();
+			for (int y = 0; y < tileY; ++y)
+			{
+				spans.clear();
+				for (int x = 0; x < tileX; ++x)
+				{
+					const std::size_t index = static_cast<std::size_t>(y) * tileX + x;
+					if (current[index] == previous[index])
+					{
+						continue;
+					}
+					++dirtyTileNum;
+					if (!spans.empty() && spans.back().x + spans.back().w == x * tileSize)
+					{
+						spans.back().w += tileSize;
+					}
+					else
+					{
+						spans.push_back({ x * tileSize, y * tileSize, tileSize, tileSize });
+					}
+				}
+				nextOpenRects.clear();
+				for (const auto& span : spans)
+				{
+					const auto itr = std::find_if(openRects.begin(), openRects.end(), [&](const std::size_t i)
+					{
+						return rects[i].x == span.x && rects[i].w == span.w;
+					});
+					if (itr != openRects.end())
+					{
+						rects[*itr].h += tileSize;
+						nextOpenRects.push_back(*itr);
+					}
+					else
+					{
+						nextOpenRects.push_back(rects.size());
+						rects.push_back(span);
+					}
+				}
+				openRects.swap(nextOpenRects);
+			}
+			for (auto& rect : rects)
+			{
+				rect.w = std::min(rect.w, screenWidth - rect.x);
+				rect.h = std::min(rect.h, screenHeight - rect.y);
+			}
+			if (rects.size() > MaxRectNum)
+			{
+				SDL_Rect box = rects[0];
+				for (const auto& rect : rects)
+				{
+					const int right = std::max(box.x + box.w, rect.x + rect.w);
+					const int bottom = std::max(box.y + box.h, rect.y + rect.h);
+					box.x = std::min(box.x, rect.x);
+					box.y = std::min(box.y, rect.y);
+					box.w = right - box.x;
+					box.h = bottom - box.y;
+				}
+				rects.assign(1, box);
+			}
+		}
+		static std::uint64_t hashCommand(const RenderCommand& command, const SDL_Rect& viewport) noexcept
+		{
+			std::uint64_t hash = Seed;
+			const auto mix = [&hash](const std::uint64_t value) { hash = (hash ^ value) * Prime; };
+			mix(static_cast<std::uint64_t>(command.type));
+			mix(reinterpret_cast<std::uintptr_t>(command.texture));
+			mix(pack(command.src.x, command.src.y));
+			mix(pack(command.src.w, command.src.h));
+			mix(pack(command.dst.x, command.dst.y));
+			mix(pack(command.dst.w, command.dst.h));
+			mix(pack(command.pivot.x, command.pivot.y));
+			mix(pack(viewport.x, viewport.y));
+			mix(pack(viewport.w, viewport.h));
+			mix(pack(static_cast<int>(command.part), static_cast<int>(command.revision)));
+			mix(reinterpret_cast<std::uintptr_t>(command.geometry));
+			std::uint64_t angle = 0;
+			std::memcpy(&angle, &command.angle, sizeof(angle));
+			mix(angle);
+			mix(static_cast<std::uint64_t>(command.color.r) | (command.color.g << 8) | (command.color.b << 16) | (static_cast<std::uint64_t>(command.color.a) << 24));
+			mix(static_cast<std::uint64_t>(command.flip) | (static_cast<std::uint64_t>(command.blendMode) << 8) |
+				(static_cast<std::uint64_t>(command.useBlend) << 40) | (static_cast<std::uint64_t>(command.useRotation) << 48));
+			return hash;
+		}
+		static std::uint64_t pack(const int a, const int b) noexcept
+		{
+			return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(a)) << 32) | static_cast<std::uint32_t>(b);
+		}
+	private:
+		static constexpr std::uint64_t Seed = 14695981039346656037ull;
+		static constexpr std::uint64_t Prime = 1099511628211ull;
+		std::vector<std::uint64_t> previous;
+		std::vector<std::uint64_t> current;
+		std::vector<SDL_Rect> spans;
+		std::vector<std::size_t> openRects;
+		std::vector<std::size_t> nextOpenRects;
+		int screenWidth = 0;
+		int screenHeight = 0;
+		int tileSize = DefaultTileSize;
+		int tileX = 0;
+		int tileY = 0;
+		std::uint32_t lastClearColor = 0;
+		std::size_t dirtyTileNum = 0;
+		bool fullRedraw = true;
+	};
+}
@@ -0,0 +1,201 @@
+//---------------------------------------------------------
+//!@file DrawScene.hpp
+//!@brief 描画するもの(プロキシ)を保持し、ビューで間引いて描画リストを作ります
+//!@author Volka
+//!@date 2018/11/3
+//!@note 描画系のComponentは毎フレーム自分のプロキシを更新し、
+//!@note RendererSystem が Present の前に見えているものだけをコマンドリストに積みます
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "RenderCommand.hpp"
+#include "SpatialGrid.hpp"
+
+namespace Render
+{
+	//!@class DrawProxy
+	//!@brief 1つの描画の、ワールド座標でのコマンドと範囲
+	struct DrawProxy
+	{
+		RenderCommand command;
+		SDL_Rect bounds = { 0, 0, 0, 0 };
+		std::uint64_t sequence = 0;		//作成順(描画順)
+		std::uint32_t submitStamp = 0;	//最後に更新されたフレーム
+		std::uint32_t visibleStamp = 0;	//最後に見えていたフレーム
+		bool alive = false;
+	};
+
+	//!@class DrawScene
+	//!@note 並列に更新されるワールドの描画系Componentからも触られるので、プロキシの操作はロックを取ります
+	class DrawScene final
+	{
+	public:
+		//!@brief プロキシを作ります
+		[[nodiscard]] ProxyID create()
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			ProxyID id;
+			if (!freeIDs.empty())
+			{
+				id = freeIDs.back();
+				freeIDs.pop_back();
+			}
+			else
+			{
+				id = static_cast<ProxyID>(proxies.size());
+				proxies.emplace_back();
+			}
+			proxies[id] = DrawProxy();
+			proxies[id].sequence = nextSequence++;
+			proxies[id].alive = true;
+			return id;
+		}
+		//!@brief プロキシを破棄します
+		void remove(const ProxyID id)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			if (id >= proxies.size() || !proxies[id].alive)
+			{
+				return;
+			}
+			grid.remove(id);
+			proxies[id].alive = false;
+			freeIDs.emplace_back(id);
+		}
+		//!@brief 今フレームの[command]と範囲[bounds]を設定します
+		//!@note このフレームで更新されなかったプロキシは描画されません
+		void update(const ProxyID id, const RenderCommand& command, const SDL_Rect& bounds)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			DrawProxy& proxy = proxies[id];
+			proxy.command = command;
+			proxy.bounds = bounds;
+			proxy.submitStamp = frameStamp;
+			grid.update(id, bounds);
+		}
+		//!@brief 前のフレームと同じコマンドと範囲のまま、今フレームも描画します
+		//!@note 変わっていないものはコマンドを作り直さずにこれを呼べば、空間グリッドも触りません
+		void keep(const ProxyID id)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			proxies[id].submitStamp = frameStamp;
+		}
+		//!@brief [view]と重なっている今フレームのプロキシを、作成順に[out]へ追加します
+		void collect(const SDL_Rect& view, std::vector<ProxyID>& out)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			const std::size_t begin = out.size();
+			if (cullingEnabled)
+			{
+				grid.query(view, [&](const ProxyID id)
+				{
+					DrawProxy& proxy = proxies[id];
+					if (proxy.alive && proxy.submitStamp == frameStamp && IsOverlap(proxy.bounds, view))
+					{
+						proxy.visibleStamp = frameStamp;
+						out.emplace_back(id);
+					}
+				});
+			}
+			else
+			{
+				for (ProxyID id = 0; id < proxies.size(); ++id)
+				{
+					DrawProxy& proxy = proxies[id];
+					if (proxy.alive && proxy.submitStamp == frameStamp)
+					{
+						proxy.visibleStamp = frameStamp;
+						out.emplace_back(id);
+					}
+				}
+			}
+			std::sort(out.begin() + begin, out.end(), [this](const ProxyID a, const ProxyID b)
+			{
+				return proxies[a].sequence < proxies[b].sequence;
+			});
+		}
+		//!@brief フレームの描画リストを作り終えたことを通知します
+		void endFrame()
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			lastStamp = frameStamp;
+			++frameStamp;
+		}
+		//!@brief 直前のフレームで[id]が見えていたか
+		[[nodiscard]] bool isVisible(const ProxyID id) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			return id < proxies.size() && proxies[id].visibleStamp == lastStamp && lastStamp != 0;
+		}
+		//!@brief プロキシを取得します
+		//!@note 参照は create() で動くことがあるので、ワールドの更新が並列に走っていないときに使ってください
+		[[nodiscard]] const DrawProxy& getProxy(const ProxyID id) const noexcept
+		{
+			return proxies[id];
+		}
+		//!@brief 間引きの有効/無効を設定します(無効なら更新されたものをすべて描画)
+		void setCullingEnabled(const bool enabled) noexcept
+		{
+			cullingEnabled = enabled;
+		}
+		[[nodiscard]] bool isCullingEnabled() const noexcept
+		{
+			return cullingEnabled;
+		}
+		//!@brief Componentの破棄が最後になっても使えるように、意図的に解放しません
+		[[nodiscard]] static DrawScene& get() noexcept
+		{
+			static DrawScene* drawScene = new DrawScene();
+			return *drawScene;
+		}
+	private:
+		SpatialGrid grid;
+		std::vector<DrawProxy> proxies;
+		std::vector<ProxyID> freeIDs;
+		std::uint64_t nextSequence = 0;
+		std::uint32_t frameStamp = 1;
+		std::uint32_t lastStamp = 0;
+		bool cullingEnabled = true;
+		mutable std::mutex mutex;
+	};
+
+	//!@class ProxyHandle
+	//!@brief Componentが持つプロキシ。破棄すると削除されます
+	//!@note コピーしてもプロキシは共有せず空になるので、Componentを複製しても二重に削除されません
+	class ProxyHandle final
+	{
+	public:
+		ProxyHandle() noexcept = default;
+		ProxyHandle(const ProxyHandle&) noexcept {}
+		ProxyHandle& operator=(const ProxyHandle&) noexcept
+		{
+			return *this;
+		}
+		~ProxyHandle()
+		{
+			reset();
+		}
+		//!@brief プロキシを作り直します
+		void create()
+		{
+			reset();
+			id = DrawScene::get().create();
+		}
+		//!@brief プロキシを削除します
+		void reset()
+		{
+			DrawScene::get().remove(id);
+			id = InvalidProxy;
+		}
+		operator ProxyID() const noexcept
+		{
+			return id;
+		}
+	private:
+		ProxyID id = InvalidProxy;
+	};
+}
@@ -0,0 +1,209 @@
+//---------------------------------------------------------
+//!@file PixelConvert.hpp
+//!@brief 読み込んだ画像を texture と同じピクセル形式にそろえます
+//!@author Volka
+//!@date 2018/11/3
+//!@note texture はすべて ARGB8888 で作るので、SDL_UpdateTexture は行のコピーだけで済みます
+//!@note RGBA の入れ替えと乗算済みアルファへの変換は SSE2 で4ピクセルずつ行います
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOLKA_PIXEL_SSE2
+#endif
+
+namespace Render
+{
+	//!@brief texture のピクセル形式(SDL2 のどのレンダラーでも使えます)
+	constexpr Uint32 TextureFormat = SDL_PIXELFORMAT_ARGB8888;
+
+	//!@brief [src]の赤と青を入れ替えて[dst]に書きます(ABGR8888 <-> ARGB8888)
+	//!@note [src]と[dst]は同じでも構いません
+	inline void SwapRedBlue(const std::uint32_t* src, std::uint32_t* dst, const std::size_t count) noexcept
+	{
+		std::size_t i = 0;
+#ifdef VOLKA_PIXEL_SSE2
+		const __m128i keepMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+		const __m128i lowMask = _mm_set1_epi32(0x000000FF);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i red = _mm_and_si128(_mm_srli_epi32(pixel, 16), lowMask);
+			const __m128i blue = _mm_slli_epi32(_mm_and_si128(pixel, lowMask), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+				_mm_or_si128(_mm_and_si128(pixel, keepMask), _mm_or_si128(red, blue)));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const std::uint32_t pixel = src[i];
+			dst[i] = (pixel & 0xFF00FF00u) | ((pixel >> 16) & 0xFFu) | ((pixel & 0xFFu) << 16);
+		}
+	}
+
+	//!@brief ARGB8888 の[src]の色にアルファを掛けて[dst]に書きます(アルファはそのまま)
+	//!@note c * a / 255 を四捨五入します。[src]と[dst]は同じでも構いません
+	inline void PremultiplyAlpha(const std::uint32_t* src, std::uint32_t* dst, const std::size_t count) noexcept
+	{
+		std::size_t i = 0;
+#ifdef VOLKA_PIXEL_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i half = _mm_set1_epi16(128);
+		//アルファのレーンには 255 を掛けて値を変えない
+		const __m128i colorLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+		const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+		const auto multiply4 = [&](const __m128i color)
+		{
+			__m128i alpha = _mm_shufflelo_epi16(color, _MM_SHUFFLE(3, 3, 3, 3));
+			alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+			alpha = _mm_or_si128(_mm_and_si128(alpha, colorLanes), alphaLanes);
+			const __m128i t = _mm_add_epi16(_mm_mullo_epi16(color, alpha), half);
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		};
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i low = multiply4(_mm_unpacklo_epi8(pixel, zero));
+			const __m128i high = multiply4(_mm_unpackhi_epi8(pixel, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+		}
+#endif
+		const auto multiply = [](const std::uint32_t c, const std::uint32_t a)
+		{
+			const std::uint32_t t = c * a + 128;
+			return (t + (t >> 8)) >> 8;
+		};
+		for (; i < count; ++i)
+		{
+			const std::uint32_t pixel = src[i];
+			const std::uint32_t a = pixel >> 24;
+			dst[i] = (pixel & 0xFF000000u) |
+				(multiply((pixel >> 16) & 0xFFu, a) << 16) |
+				(multiply((pixel >> 8) & 0xFFu, a) << 8) |
+				multiply(pixel & 0xFFu, a);
+		}
+	}
+
+	//!@brief 乗算済みアルファの texture 用のブレンドモード(dst = src + dst * (1 - srcA))
+	[[nodiscard]] inline SDL_BlendMode GetPremultipliedBlendMode() noexcept
+	{
+		return SDL_ComposeCustomBlendMode(
+			SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+			SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+	}
+
+	//!@brief [surface]を TextureFormat に変換した新しい surface を返します([surface]は解放しません)
+	//!@param premultiply true なら色にアルファを掛けておきます
+	//!@note カラーキーはアルファに変換されます。失敗したら nullptr
+	[[nodiscard]] inline SDL_Surface* NormalizeSurface(SDL_Surface* surface, const bool premultiply) noexcept
+	{
+		Uint32 colorKey = 0;
+		const bool hasColorKey = SDL_GetColorKey(surface, &colorKey) == 0;
+		const Uint32 format = surface->format->format;
+		SDL_Surface* result = nullptr;
+		if (!hasColorKey && (format == SDL_PIXELFORMAT_ABGR8888 || format == TextureFormat))
+		{
+			//PNG の RGBA はここに来るので、SDL_ConvertSurfaceFormat の汎用の変換を通さない
+			result = SDL_CreateRGBSurfaceWithFormat(0, surface->w, surface->h, 32, TextureFormat);
+			if (result == nullptr)
+			{
+				return nullptr;
+			}
+			if (SDL_MUSTLOCK(surface))
+			{
+				SDL_LockSurface(surface);
+			}
+			for (int y = 0; y < surface->h; ++y)
+			{
+				const auto* srcRow = reinterpret_cast<const std::uint32_t*>(static_cast<const std::uint8_t*>(surface->pixels) + y * surface->pitch);
+				auto* dstRow = reinterpret_cast<std::uint32_t*>(static_cast<std::uint8_t*>(result->pixels) + y * result->pitch);
+				if (format == TextureFormat)
+				{
+					std::memcpy(dstRow, srcRow, static_cast<std::size_t>(surface->w) * sizeof(std::uint32_t));
+				}
+				else
+				{
+					SwapRedBlue(srcRow, dstRow, static_cast<std::size_t>(surface->w));
+				}
+			}
+			if (SDL_MUSTLOCK(surface))
+			{
+				SDL_UnlockSurface(surface);
+			}
+		}
+		else
+		{
+			//パレットや24bit、カラーキー付きは SDL に任せる
+			result = SDL_ConvertSurfaceFormat(surface, TextureFormat, 0);
+			if (result == nullptr)
+			{
+				return nullptr;
+			}
+		}
+		if (premultiply)
+		{
+			for (int y = 0; y < result->h; ++y)
+			{
+				auto* row = reinterpret_cast<std::uint32_t*>(static_cast<std::uint8_t*>(result->pixels) + y * result->pitch);
+				PremultiplyAlpha(row, row, static_cast<std::size_t>(result->w));
+			}
+		}
+		return result;
+	}
+
+	//!@brief [texture]に画像に合ったブレンドモードを設定します
+	//!@param premultiplied 乗算済みアルファの画像か
+	inline void SetTextureBlend(SDL_Texture* texture, const bool premultiplied) noexcept
+	{
+		if (premultiplied && SDL_SetTextureBlendMode(texture, GetPremultipliedBlendMode()) == 0)
+		{
+			return;
+		}
+		if (premultiplied)
+		{
+			//ソフトウェアレンダラーなどは独自のブレンドモードを使えない(縁が少し暗くなります)
+			std::cerr << "premultiplied blend: " << SDL_GetError() << std::endl;
+		}
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	}
+
+	//!@brief TextureFormat の[pixels]から texture を作ります
+	//!@param premultiplied [pixels]が乗算済みアルファか
+	//!@return 失敗したら nullptr
+	[[nodiscard]] inline SDL_Texture* CreateTexture(SDL_Renderer* renderer, const void* pixels,
+		const int width, const int height, const int pitch, const bool premultiplied) noexcept
+	{
+		SDL_Texture* texture = SDL_CreateTexture(renderer, TextureFormat, SDL_TEXTUREACCESS_STATIC, width, height);
+		if (texture == nullptr)
+		{
+			return nullptr;
+		}
+		if (SDL_UpdateTexture(texture, nullptr, pixels, pitch) != 0)
+		{
+			SDL_DestroyTexture(texture);
+			return nullptr;
+		}
+		SetTextureBlend(texture, premultiplied);
+		return texture;
+	}
+
+	//!@brief NormalizeSurface() で変換した[surface]から texture を作ります
+	[[nodiscard]] inline SDL_Texture* CreateTexture(SDL_Renderer* renderer, SDL_Surface* surface, const bool premultiplied) noexcept
+	{
+		if (SDL_MUSTLOCK(surface))
+		{
+			SDL_LockSurface(surface);
+		}
+		SDL_Texture* texture = CreateTexture(renderer, surface->pixels, surface->w, surface->h, surface->pitch, premultiplied);
+		if (SDL_MUSTLOCK(surface))
+		{
+			SDL_UnlockSurface(surface);
+		}
+		return texture;
+	}
+}
@@ -0,0 +1,261 @@
+//---------------------------------------------------------
+//!@file RenderCommand.hpp
+//!@brief 描画コマンドとコマンドリストを用意します
+//!@author Volka
+//!@date 2018/11/3
+//!@note Componentは SDL を直接呼ばずにコマンドを積み、描画スレッドがまとめて実行します
+//!@note コマンドリストは容量を残したまま使い回すので、毎フレームのヒープ確保はありません
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace Render
+{
+	enum class CommandType : std::uint8_t
+	{
+		Clear,		//塗りつぶし
+		FillRect,	//矩形の塗りつぶし
+		DrawRect,	//矩形の枠
+		DrawLine,	//線 (dst.x, dst.y) - (dst.w, dst.h)
+		DrawPoint,	//点 (dst.x, dst.y)
+		Copy,		//textureの描画
+		Geometry,	//リストの頂点 [first, first + count) の三角形を描画(dst は範囲)
+		Viewport,	//ビューポートの設定
+		SetClip,	//クリップ矩形の設定(スクリーン座標、dst.w が 0 なら解除)
+		Present,	//画面に反映
+		PresentRects,	//リストの矩形 [first, first + count) だけを画面に反映(ソフトウェアレンダラ)
+	};
+
+	//!@class GeometrySource
+	//!@brief 頂点をコマンドリストに積むときに作って渡すもの(タイルマップのチャンク、パーティクルなど)
+	//!@note 呼ばれるのはメインスレッドで、頂点はリストへ直接書き込みます
+	class GeometrySource
+	{
+	public:
+		virtual ~GeometrySource() = default;
+		//!@brief [part]の三角形リストの頂点数を取得します
+		virtual std::size_t getVertexCount(const std::uint32_t part) = 0;
+		//!@brief [part]の頂点を[out]へ getVertexCount() 個書き込みます
+		virtual void writeVertices(const std::uint32_t part, SDL_Vertex* out) = 0;
+	};
+
+	//!@class RenderCommand
+	//!@brief 1回分の描画に必要な値をすべて持ちます(描画時に他のComponentを参照しない)
+	struct RenderCommand
+	{
+		CommandType type = CommandType::Clear;
+		SDL_RendererFlip flip = SDL_FLIP_NONE;
+		SDL_BlendMode blendMode = SDL_BLENDMODE_NONE;
+		bool useBlend = false;
+		bool useRotation = false;
+		SDL_Color color = { 0xFF, 0xFF, 0xFF, 0xFF };
+		SDL_Texture* texture = nullptr;
+		SDL_Rect src = { 0, 0, 0, 0 };
+		SDL_Rect dst = { 0, 0, 0, 0 };
+		SDL_Point pivot = { 0, 0 };
+		double angle = 0.0;
+		std::uint32_t first = 0;
+		std::uint32_t count = 0;
+		GeometrySource* geometry = nullptr;	//Geometry: リストに積むまでの頂点の取得先
+		std::uint32_t part = 0;				//Geometry: [geometry]に渡す番号
+		std::uint32_t revision = 0;			//Geometry: 頂点の内容が変わるたびに増やす
+	};
+
+	//!@brief [command]が描画するおおよその範囲(描画しないコマンドは空)
+	//!@note 回転するときはピボット中心で回転しても収まる範囲にします
+	inline SDL_Rect GetCommandBounds(const RenderCommand& command) noexcept
+	{
+		switch (command.type)
+		{
+		case CommandType::FillRect:
+		case CommandType::DrawRect:
+		case CommandType::Geometry:
+			return command.dst;
+		case CommandType::DrawLine:
+			return { std::min(command.dst.x, command.dst.w), std::min(command.dst.y, command.dst.h),
+				std::abs(command.dst.w - command.dst.x) + 1, std::abs(command.dst.h - command.dst.y) + 1 };
+		case CommandType::DrawPoint:
+			return { command.dst.x, command.dst.y, 1, 1 };
+		case CommandType::Copy:
+		{
+			if (!command.useRotation)
+			{
+				return command.dst;
+			}
+			const int px = command.pivot.x;
+			const int py = command.pivot.y;
+			const int dx = std::max(std::abs(px), std::abs(command.dst.w - px));
+			const int dy = std::max(std::abs(py), std::abs(command.dst.h - py));
+			const int radius = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy)));
+			return { command.dst.x + px - radius, command.dst.y + py - radius, radius * 2, radius * 2 };
+		}
+		default:
+			return { 0, 0, 0, 0 };
+		}
+	}
+
+	//!@class RenderCommandList
+	//!@brief 1フレーム分の描画コマンド
+	//!@note 描画スレッドに渡した後は、実行が終わるまで読み込み専用です
+	class RenderCommandList final
+	{
+	public:
+		//!@brief コマンドを追加します
+		RenderCommand& push(const RenderCommand& command)
+		{
+			commands.emplace_back(command);
+			return commands.back();
+		}
+		//!@brief コマンドが参照する矩形を追加し、先頭の位置を返します
+		std::uint32_t pushRects(const SDL_Rect* data, const std::size_t count)
+		{
+			const std::uint32_t first = static_cast<std::uint32_t>(rects.size());
+			rects.insert(rects.end(), data, data + count);
+			return first;
+		}
+		//!@brief コマンドが参照する頂点を[count]個確保し、先頭を返します
+		SDL_Vertex* allocateVertices(const std::size_t count, std::uint32_t& first)
+		{
+			first = static_cast<std::uint32_t>(vertices.size());
+			vertices.resize(vertices.size() + count);
+			return vertices.data() + first;
+		}
+		//!@brief コマンドをすべて消します(容量は残ります)
+		void clear() noexcept
+		{
+			commands.clear();
+			rects.clear();
+			vertices.clear();
+		}
+		//!@brief コマンドだけを消します(矩形と頂点は残ります)
+		void clearCommands() noexcept
+		{
+			commands.clear();
+		}
+		//!@brief 予定しているコマンド数分を確保しておきます
+		void reserve(const std::size_t count)
+		{
+			commands.reserve(count);
+		}
+		[[nodiscard]] const RenderCommand* begin() const noexcept { return commands.data(); }
+		[[nodiscard]] const RenderCommand* end() const noexcept { return commands.data() + commands.size(); }
+		[[nodiscard]] std::size_t size() const noexcept { return commands.size(); }
+		[[nodiscard]] bool empty() const noexcept { return commands.empty(); }
+		[[nodiscard]] const SDL_Rect* getRects() const noexcept { return rects.data(); }
+		[[nodiscard]] const SDL_Vertex* getVertices() const noexcept { return vertices.data(); }
+	private:
+		std::vector<RenderCommand> commands;
+		std::vector<SDL_Rect> rects;
+		std::vector<SDL_Vertex> vertices;
+	};
+
+	//!@class RenderExecutor
+	//!@brief コマンドを SDL_Renderer で実行します
+	class RenderExecutor final
+	{
+	public:
+		//!@brief [list]のコマンドを順に実行します
+		static void execute(SDL_Renderer* renderer, const RenderCommandList& list) noexcept
+		{
+			//SDL のクリップ矩形はビューポート基準なので、スクリーン座標で覚えておいて付け直す
+			SDL_Rect viewport = { 0, 0, 0, 0 };
+			SDL_Rect clip = { 0, 0, 0, 0 };
+			for (const auto& command : list)
+			{
+				switch (command.type)
+				{
+				case CommandType::Viewport:
+					SDL_RenderSetViewport(renderer, &command.dst);
+					viewport = command.dst;
+					applyClip(renderer, clip, viewport);
+					break;
+				case CommandType::SetClip:
+					clip = command.dst;
+					applyClip(renderer, clip, viewport);
+					break;
+				case CommandType::Geometry:
+					if (command.useBlend && command.texture != nullptr)
+					{
+						SDL_SetTextureBlendMode(command.texture, command.blendMode);
+						SDL_SetTextureAlphaMod(command.texture, command.color.a);
+					}
+					SDL_RenderGeometry(renderer, command.texture, list.getVertices() + command.first, static_cast<int>(command.count), nullptr, 0);
+					break;
+				case CommandType::PresentRects:
+					SDL_RenderFlush(renderer);
+					SDL_UpdateWindowSurfaceRects(SDL_RenderGetWindow(renderer), list.getRects() + command.first, static_cast<int>(command.count));
+					break;
+				default:
+					execute(renderer, command);
+					break;
+				}
+			}
+		}
+		//!@brief 1つのコマンドを実行します
+		static void execute(SDL_Renderer* renderer, const RenderCommand& command) noexcept
+		{
+			switch (command.type)
+			{
+			case CommandType::Clear:
+				SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+				SDL_RenderClear(renderer);
+				break;
+			case CommandType::FillRect:
+				SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+				SDL_RenderFillRect(renderer, &command.dst);
+				break;
+			case CommandType::DrawRect:
+				SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+				SDL_RenderDrawRect(renderer, &command.dst);
+				break;
+			case CommandType::DrawLine:
+				SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+				SDL_RenderDrawLine(renderer, command.dst.x, command.dst.y, command.dst.w, command.dst.h);
+				break;
+			case CommandType::DrawPoint:
+				SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+				SDL_RenderDrawPoint(renderer, command.dst.x, command.dst.y);
+				break;
+			case CommandType::Copy:
+				if (command.useBlend)
+				{
+					SDL_SetTextureBlendMode(command.texture, command.blendMode);
+					SDL_SetTextureAlphaMod(command.texture, command.color.a);
+				}
+				if (command.useRotation)
+				{
+					SDL_RenderCopyEx(renderer, command.texture, &command.src, &command.dst, command.angle, &command.pivot, command.flip);
+				}
+				else
+				{
+					SDL_RenderCopy(renderer, command.texture, &command.src, &command.dst);
+				}
+				break;
+			case CommandType::Viewport:
+				SDL_RenderSetViewport(renderer, &command.dst);
+				break;
+			case CommandType::Present:
+				SDL_RenderPresent(renderer);
+				break;
+			default:
+				break;
+			}
+		}
+	private:
+		static void applyClip(SDL_Renderer* renderer, const SDL_Rect& clip, const SDL_Rect& viewport) noexcept
+		{
+			if (clip.w <= 0 || clip.h <= 0)
+			{
+				SDL_RenderSetClipRect(renderer, nullptr);
+				return;
+			}
+			const SDL_Rect local = { clip.x - viewport.x, clip.y - viewport.y, clip.w, clip.h };
+			SDL_RenderSetClipRect(renderer, &local);
+		}
+	};
+}
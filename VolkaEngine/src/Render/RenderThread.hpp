@@ -0,0 +1,159 @@
+//---------------------------------------------------------
+//!@file RenderThread.hpp
+//!@brief コマンドリストを実行する描画スレッド
+//!@author Volka
+//!@date 2018/11/3
+//!@note シミュレーションがフレームN+1を計算している間に、フレームNを描画します
+//!@note 既定では SDL_Renderer を作ったメインスレッドで描画し、シミュレーションの方をワーカーで行います(Job::MainThread)
+//!@note 同時に描画待ちにできるのは1フレームだけです(フレームアロケータのダブルバッファと対応)
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "RenderCommand.hpp"
+#include "../Job/MainThread.hpp"
+
+namespace Render
+{
+	//!@class RenderThread
+	class RenderThread final
+	{
+	public:
+		RenderThread() = default;
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+		~RenderThread()
+		{
+			stop();
+		}
+		//!@brief [sdlRenderer]で描画を始めます
+		//!@param threaded true:専用のスレッドで描画する  false:メインスレッドで描画する
+		//!@note OpenGL のようにコンテキストがスレッドに結び付くバックエンドでは false にしてください
+		//!@note false のときは submit() したリストを Job::MainThread にためておき、
+		//!@note 次のフレームの Job::MainThread::runWhile() の間にシミュレーションと並行して描画します
+		void start(SDL_Renderer* sdlRenderer, const bool threaded)
+		{
+			stop();
+			renderer = sdlRenderer;
+			queued = false;
+			//SDL_Renderer を作ったこのスレッドをメインスレッドにする(ワーカーから先に get() されないように)
+			Job::MainThread::get();
+			if (threaded)
+			{
+				running = true;
+				thread = std::thread([this]() { run(); });
+			}
+		}
+		//!@brief 描画を止めます(描画待ちのリストは実行してから止まります)
+		void stop()
+		{
+			if (!thread.joinable())
+			{
+				if (queued)
+				{
+					Job::MainThread::get().invoke([]() {});
+				}
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				running = false;
+			}
+			condition.notify_all();
+			thread.join();
+		}
+		//!@brief 1フレーム分のリストを渡します
+		//!@brief 前のフレームの描画が終わるまで待ってから渡します
+		void submit(const RenderCommandList& list)
+		{
+			if (!thread.joinable())
+			{
+				auto& mainThread = Job::MainThread::get();
+				//前のフレームのリストが描画されないまま残っていれば、ここで描画する
+				if (queued)
+				{
+					mainThread.drain();
+				}
+				queued = true;
+				mainThread.post([this, &list]()
+				{
+					RenderExecutor::execute(renderer, list);
+					queued = false;
+				});
+				return;
+			}
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return pending == nullptr && !busy; });
+			pending = &list;
+			lock.unlock();
+			condition.notify_all();
+		}
+		//!@brief 描画待ちのリストがなくなるまで待ちます
+		void waitIdle()
+		{
+			if (!thread.joinable())
+			{
+				Job::MainThread::get().invoke([]() {});
+				return;
+			}
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return pending == nullptr && !busy; });
+		}
+		//!@brief 描画待ちのリストがなくなってから、[task]を描画と重ならないように実行します
+		//!@note SDL を触る処理(texture の作成・破棄など)はこの中で行います
+		//!@note メインスレッドで描画するときは、ワーカーから呼んでもメインスレッドで実行します
+		void invoke(const std::function<void()>& task)
+		{
+			if (!thread.joinable())
+			{
+				Job::MainThread::get().invoke(task);
+				return;
+			}
+			waitIdle();
+			task();
+		}
+		//!@brief 描画スレッドで動いているか
+		[[nodiscard]] bool isThreaded() const noexcept
+		{
+			return thread.joinable();
+		}
+	private:
+		void run()
+		{
+			for (;;)
+			{
+				const RenderCommandList* list = nullptr;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [this]() { return pending != nullptr || !running; });
+					if (pending == nullptr)
+					{
+						return;
+					}
+					list = pending;
+					pending = nullptr;
+					busy = true;
+				}
+				RenderExecutor::execute(renderer, *list);
+				{
+					std::lock_guard<std::mutex> guard(mutex);
+					busy = false;
+				}
+				condition.notify_all();
+			}
+		}
+	private:
+		SDL_Renderer* renderer = nullptr;
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		const RenderCommandList* pending = nullptr;
+		bool busy = false;
+		bool running = false;
+		//メインスレッドで描画するときに、Job::MainThread に描画待ちのリストがあるか(メインスレッドだけが触る)
+		bool queued = false;
+	};
+}
@@ -0,0 +1,160 @@
+//---------------------------------------------------------
+//!@file SpatialGrid.hpp
+//!@brief 矩形を一様なグリッドに登録し、範囲で検索します
+//!@author Volka
+//!@date 2018/11/3
+//!@note 矩形が同じセルの範囲にある間は登録し直さないので、止まっている物のコストはありません
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Render
+{
+	using ProxyID = std::uint32_t;
+	//作成されていないプロキシ
+	constexpr ProxyID InvalidProxy = 0xFFFFFFFF;
+
+	//!@brief 2つの矩形が重なっているか
+	inline bool IsOverlap(const SDL_Rect& a, const SDL_Rect& b) noexcept
+	{
+		return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+	}
+
+	//!@class SpatialGrid
+	class SpatialGrid final
+	{
+	public:
+		static constexpr int DefaultCellSize = 256;
+	public:
+		explicit SpatialGrid(const int size = DefaultCellSize) noexcept
+			: cellSize(size > 0 ? size : DefaultCellSize)
+		{}
+		//!@brief [id]を[bounds]で登録します(登録済みなら更新します)
+		void update(const ProxyID id, const SDL_Rect& bounds)
+		{
+			if (id >= ranges.size())
+			{
+				ranges.resize(id + 1);
+				stamps.resize(id + 1, 0);
+			}
+			const CellRange range = toRange(bounds);
+			CellRange& current = ranges[id];
+			if (current.valid && current == range)
+			{
+				return;
+			}
+			if (current.valid)
+			{
+				removeCells(id, current);
+			}
+			for (int y = range.y0; y <= range.y1; ++y)
+			{
+				for (int x = range.x0; x <= range.x1; ++x)
+				{
+					cells[key(x, y)].emplace_back(id);
+				}
+			}
+			current = range;
+		}
+		//!@brief [id]の登録を解除します
+		void remove(const ProxyID id)
+		{
+			if (id >= ranges.size() || !ranges[id].valid)
+			{
+				return;
+			}
+			removeCells(id, ranges[id]);
+			ranges[id].valid = false;
+		}
+		//!@brief [area]と重なるセルにある[id]を1回ずつ[visitor]に渡します
+		//!@note セル単位なので、実際に重なっているかは呼び出し側で確認します
+		template<typename Visitor> void query(const SDL_Rect& area, Visitor&& visitor)
+		{
+			if (area.w <= 0 || area.h <= 0)
+			{
+				return;
+			}
+			++queryStamp;
+			const CellRange range = toRange(area);
+			for (int y = range.y0; y <= range.y1; ++y)
+			{
+				for (int x = range.x0; x <= range.x1; ++x)
+				{
+					const auto itr = cells.find(key(x, y));
+					if (itr == cells.end())
+					{
+						continue;
+					}
+					for (const ProxyID id : itr->second)
+					{
+						if (stamps[id] == queryStamp)
+						{
+							continue;
+						}
+						stamps[id] = queryStamp;
+						visitor(id);
+					}
+				}
+			}
+		}
+		//!@brief セルの大きさを取得します
+		[[nodiscard]] int getCellSize() const noexcept
+		{
+			return cellSize;
+		}
+	private:
+		struct CellRange
+		{
+			int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+			bool valid = false;
+			bool operator==(const CellRange& other) const noexcept
+			{
+				return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+			}
+		};
+		CellRange toRange(const SDL_Rect& rect) const noexcept
+		{
+			CellRange range;
+			range.x0 = floorDiv(rect.x);
+			range.y0 = floorDiv(rect.y);
+			range.x1 = floorDiv(rect.x + std::max(rect.w, 1) - 1);
+			range.y1 = floorDiv(rect.y + std::max(rect.h, 1) - 1);
+			range.valid = true;
+			return range;
+		}
+		int floorDiv(const int value) const noexcept
+		{
+			return value >= 0 ? value / cellSize : -((-value + cellSize - 1) / cellSize);
+		}
+		static std::uint64_t key(const int x, const int y) noexcept
+		{
+			return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+		}
+		void removeCells(const ProxyID id, const CellRange& range)
+		{
+			for (int y = range.y0; y <= range.y1; ++y)
+			{
+				for (int x = range.x0; x <= range.x1; ++x)
+				{
+					auto& cell = cells[key(x, y)];
+					const auto itr = std::find(cell.begin(), cell.end(), id);
+					if (itr != cell.end())
+					{
+						*itr = cell.back();
+						cell.pop_back();
+					}
+				}
+			}
+		}
+	private:
+		int cellSize;
+		std::unordered_map<std::uint64_t, std::vector<ProxyID>> cells;
+		std::vector<CellRange> ranges;
+		std::vector<std::uint32_t> stamps;
+		std::uint32_t queryStamp = 0;
+	};
+}
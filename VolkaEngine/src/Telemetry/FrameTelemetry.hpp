@@ -0,0 +1,458 @@
+//---------------------------------------------------------
+//!@file FrameTelemetry.hpp
+//!@brief フレーム時間と EntityManager ごとの処理時間を記録します
+//!@author Volka
+//!@date 2018/11/3
+//!@note 時間は HDR 形式のヒストグラム(誤差 1% 未満)に入れるので、記録する数が増えてもメモリは一定です
+//!@note 集計は EntitySystemManager::update() の先頭(ワールドを更新していない間)にまとめて行います
+//!@note 書き出しは Prometheus のテキスト形式です(node_exporter の textfile collector などで読めます)
+//---------------------------------------------------------
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace Telemetry
+{
+	//!@brief EntityManager の処理の段階
+	enum class Phase : std::size_t
+	{
+		Refresh,
+		Update,
+		Draw2D,
+		Draw3D,
+	};
+	constexpr std::size_t PhaseNum = 4;
+
+	//!@class Histogram
+	//!@brief 値を対数ごとに 64 分割した区間で数えます(HdrHistogram と同じ区切り方)
+	//!@note 値はマイクロ秒を想定していて、約35分で頭打ちになります
+	class Histogram final
+	{
+	public:
+		static constexpr unsigned SubBucketBits = 7;
+		static constexpr std::uint64_t SubBucketCount = std::uint64_t(1) << SubBucketBits;
+		static constexpr std::uint64_t HalfCount = SubBucketCount / 2;
+		static constexpr unsigned BucketNum = 24;
+		static constexpr std::uint64_t MaxValue = (SubBucketCount << BucketNum) - 1;
+		static constexpr std::size_t CountsSize = static_cast<std::size_t>((BucketNum + 2) * HalfCount);
+	public:
+		//!@brief [value]を1つ記録します
+		void record(std::uint64_t value) noexcept
+		{
+			value = value > MaxValue ? MaxValue : value;
+			++counts[getIndex(value)];
+			++totalCount;
+			maxValue = value > maxValue ? value : maxValue;
+		}
+		//!@brief [other]の記録を足します
+		void merge(const Histogram& other) noexcept
+		{
+			for (std::size_t i = 0; i < CountsSize; ++i)
+			{
+				counts[i] += other.counts[i];
+			}
+			totalCount += other.totalCount;
+			maxValue = other.maxValue > maxValue ? other.maxValue : maxValue;
+		}
+		//!@brief 記録を消します
+		void reset() noexcept
+		{
+			counts.fill(0);
+			totalCount = 0;
+			maxValue = 0;
+		}
+		//!@brief [percentile]%(0～100)の値を取得します(区間の上端、記録がなければ0)
+		[[nodiscard]] std::uint64_t getPercentile(const double percentile) const noexcept
+		{
+			if (totalCount == 0)
+			{
+				return 0;
+			}
+			if (percentile >= 100.0)
+			{
+				return maxValue;
+			}
+			const double rank = percentile <= 0.0 ? 1.0 : percentile / 100.0 * static_cast<double>(totalCount);
+			std::uint64_t target = static_cast<std::uint64_t>(rank);
+			target += static_cast<double>(target) < rank ? 1 : 0;
+			std::uint64_t sum = 0;
+			for (std::size_t i = 0; i < CountsSize; ++i)
+			{
+				sum += counts[i];
+				if (sum >= target)
+				{
+					const std::uint64_t value = getHighestValue(i);
+					return value < maxValue ? value : maxValue;
+				}
+			}
+			return maxValue;
+		}
+		[[nodiscard]] std::uint64_t getMax() const noexcept { return maxValue; }
+		[[nodiscard]] std::uint64_t getCount() const noexcept { return totalCount; }
+	private:
+		static std::size_t getIndex(const std::uint64_t value) noexcept
+		{
+			unsigned bucket = 0;
+			while ((value >> bucket) >= SubBucketCount)
+			{
+				++bucket;
+			}
+			return static_cast<std::size_t>(bucket * HalfCount + (value >> bucket));
+		}
+		//!@brief [index]の区間に入る最大の値
+		static std::uint64_t getHighestValue(const std::size_t index) noexcept
+		{
+			if (index < SubBucketCount)
+			{
+				return index;
+			}
+			const std::uint64_t bucket = (index - SubBucketCount) / HalfCount + 1;
+			const std::uint64_t sub = (index - SubBucketCount) % HalfCount + HalfCount;
+			return ((sub + 1) << bucket) - 1;
+		}
+	private:
+		std::array<std::uint32_t, CountsSize> counts{};
+		std::uint64_t totalCount = 0;
+		std::uint64_t maxValue = 0;
+	};
+
+	//!@class PhaseCounter
+	//!@brief EntityManager が持つ、そのフレームの段階ごとの処理時間と数
+	//!@note ワールドはワーカースレッドで更新されるので、値は relaxed な atomic で持ちます
+	class PhaseCounter final
+	{
+	public:
+		//!@brief [phase]に[nanoseconds]を足します
+		void add(const Phase phase, const std::int64_t nanoseconds) noexcept
+		{
+			nanos[static_cast<std::size_t>(phase)].fetch_add(nanoseconds, std::memory_order_relaxed);
+		}
+		//!@brief [phase]の値を取り出して0に戻します
+		[[nodiscard]] std::int64_t take(const Phase phase) noexcept
+		{
+			return nanos[static_cast<std::size_t>(phase)].exchange(0, std::memory_order_relaxed);
+		}
+		//!@brief Entity と Component の数を設定します
+		void setCount(const std::size_t entity, const std::size_t component) noexcept
+		{
+			entityNum.store(entity, std::memory_order_relaxed);
+			componentNum.store(component, std::memory_order_relaxed);
+		}
+		[[nodiscard]] std::size_t getEntityNum() const noexcept { return entityNum.load(std::memory_order_relaxed); }
+		[[nodiscard]] std::size_t getComponentNum() const noexcept { return componentNum.load(std::memory_order_relaxed); }
+	private:
+		std::array<std::atomic<std::int64_t>, PhaseNum> nanos{};
+		std::atomic<std::size_t> entityNum{ 0 };
+		std::atomic<std::size_t> componentNum{ 0 };
+	};
+
+	//!@class ScopedPhase
+	//!@brief スコープを抜けるまでの時間を PhaseCounter に足します
+	class ScopedPhase final
+	{
+	public:
+		ScopedPhase(PhaseCounter& phaseCounter, const Phase measurePhase) noexcept
+			: counter(phaseCounter), phase(measurePhase), start(std::chrono::steady_clock::now()) {}
+		ScopedPhase(const ScopedPhase&) = delete;
+		ScopedPhase& operator=(const ScopedPhase&) = delete;
+		~ScopedPhase()
+		{
+			counter.add(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		}
+	private:
+		PhaseCounter& counter;
+		Phase phase;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	//!@class TimeStats
+	//!@brief 直近の区間の時間の統計(マイクロ秒)
+	struct TimeStats
+	{
+		std::uint64_t p50 = 0;
+		std::uint64_t p99 = 0;
+		std::uint64_t max = 0;
+		std::uint64_t count = 0;
+	};
+
+	//!@class FrameStats
+	//!@brief フレーム時間の統計
+	struct FrameStats
+	{
+		TimeStats time;
+		std::uint64_t lastFrame = 0;	//直前のフレーム(マイクロ秒)
+		std::uint64_t frameCount = 0;
+		std::uint64_t hitchCount = 0;	//しきい値を超えたフレームの数(起動してから)
+	};
+
+	//!@class ManagerStats
+	//!@brief EntityManager ごとの統計
+	struct ManagerStats
+	{
+		std::array<TimeStats, PhaseNum> phases;
+		std::size_t entityNum = 0;
+		std::size_t componentNum = 0;
+	};
+
+	//!@class FrameTelemetry
+	//!@brief フレーム時間と、名前付きの PhaseCounter(EntityManager)の時間を集計します
+	//!@note 統計は直近の[windowFrames]～2倍のフレームから求め、合計と回数は起動してからの値です
+	class FrameTelemetry final
+	{
+	public:
+		//!@brief 名前付きのカウンタを登録します(カウンタの寿命は呼び出し側で管理)
+		void registCounter(const std::string& name, PhaseCounter& counter)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			Slot& slot = slots[name];
+			slot = Slot();
+			slot.counter = &counter;
+		}
+		//!@brief 名前付きのカウンタの登録を解除します
+		void removeCounter(const std::string& name)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			slots.erase(name);
+		}
+		//!@brief [frames]フレームごとに統計の区間を進めます
+		void setWindow(const std::uint64_t frames) noexcept
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			windowFrames = frames == 0 ? 1 : frames;
+		}
+		//!@brief [threshold]より長いフレームを引っかかり(ヒッチ)として数えます
+		void setHitchThreshold(const std::chrono::microseconds threshold) noexcept
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			hitchThreshold = static_cast<std::uint64_t>(threshold.count());
+		}
+		//!@brief [frameInterval]フレームごとに[filePath]へ Prometheus 形式で書き出します(0で無効)
+		//!@note 読む側が途中の状態を見ないように、一時ファイルに書いてから置き換えます
+		void setDumpInterval(const std::uint64_t frameInterval, const std::string& filePath)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			dumpInterval = frameInterval;
+			dumpPath = filePath;
+		}
+		//!@brief フレームの区切りを通知します
+		//!@brief 前のフレームの時間とカウンタを集計し、必要なら書き出します
+		void beginFrame()
+		{
+			const auto now = std::chrono::steady_clock::now();
+			std::lock_guard<std::mutex> guard(mutex);
+			if (started)
+			{
+				const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - frameStart).count();
+				collect(static_cast<std::uint64_t>(elapsed));
+			}
+			started = true;
+			frameStart = now;
+		}
+		//!@brief フレーム時間の統計を取得します
+		[[nodiscard]] FrameStats getFrameStats() const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			FrameStats stats;
+			stats.time = getTimeStats(frame);
+			stats.lastFrame = lastFrame;
+			stats.frameCount = frame.totalCount;
+			stats.hitchCount = hitchCount;
+			return stats;
+		}
+		//!@brief [name]のカウンタの統計を取得します(未登録なら空の値)
+		[[nodiscard]] ManagerStats getManagerStats(const std::string& name) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			ManagerStats stats;
+			const auto itr = slots.find(name);
+			if (itr == slots.end())
+			{
+				return stats;
+			}
+			for (std::size_t i = 0; i < PhaseNum; ++i)
+			{
+				stats.phases[i] = getTimeStats(itr->second.phases[i]);
+			}
+			stats.entityNum = itr->second.counter->getEntityNum();
+			stats.componentNum = itr->second.counter->getComponentNum();
+			return stats;
+		}
+		//!@brief 全統計を Prometheus のテキスト形式で書き出します
+		void dump(std::ostream& os) const
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			dumpUnlocked(os);
+		}
+		[[nodiscard]] static FrameTelemetry& get() noexcept
+		{
+			static FrameTelemetry frameTelemetry;
+			return frameTelemetry;
+		}
+	private:
+		//!@brief 区間ごとのヒストグラムと、起動してからの合計
+		struct Series
+		{
+			Histogram current;
+			Histogram previous;
+			std::uint64_t totalCount = 0;
+			std::uint64_t totalMicros = 0;
+			void record(const std::uint64_t micros) noexcept
+			{
+				current.record(micros);
+				++totalCount;
+				totalMicros += micros;
+			}
+			void rotate() noexcept
+			{
+				std::swap(current, previous);
+				current.reset();
+			}
+		};
+		struct Slot
+		{
+			PhaseCounter* counter = nullptr;
+			std::array<Series, PhaseNum> phases;
+		};
+		static constexpr const char* PhaseNames[PhaseNum] = { "refresh", "update", "draw2d", "draw3d" };
+
+		void collect(const std::uint64_t frameMicros)
+		{
+			lastFrame = frameMicros;
+			frame.record(frameMicros);
+			if (frameMicros > hitchThreshold)
+			{
+				++hitchCount;
+			}
+			for (auto& slot : slots)
+			{
+				for (std::size_t i = 0; i < PhaseNum; ++i)
+				{
+					const std::int64_t nanos = slot.second.counter->take(static_cast<Phase>(i));
+					slot.second.phases[i].record(static_cast<std::uint64_t>(nanos < 0 ? 0 : nanos / 1000));
+				}
+			}
+			if (frame.totalCount % windowFrames == 0)
+			{
+				frame.rotate();
+				for (auto& slot : slots)
+				{
+					for (auto& phase : slot.second.phases)
+					{
+						phase.rotate();
+					}
+				}
+			}
+			if (dumpInterval != 0 && frame.totalCount % dumpInterval == 0)
+			{
+				writeFile();
+			}
+		}
+		static TimeStats getTimeStats(const Series& series)
+		{
+			Histogram window = series.previous;
+			window.merge(series.current);
+			TimeStats stats;
+			stats.p50 = window.getPercentile(50.0);
+			stats.p99 = window.getPercentile(99.0);
+			stats.max = window.getMax();
+			stats.count = window.getCount();
+			return stats;
+		}
+		void writeFile() const
+		{
+			const std::string tempPath = dumpPath + ".tmp";
+			{
+				std::ofstream file(tempPath, std::ios::trunc);
+				if (!file)
+				{
+					return;
+				}
+				dumpUnlocked(file);
+			}
+			std::error_code error;
+			std::filesystem::rename(tempPath, dumpPath, error);
+			if (error)
+			{
+				std::cerr << "FrameTelemetry: " << dumpPath << ": " << error.message() << std::endl;
+			}
+		}
+		//!@brief ラベルの値の \ " 改行をエスケープします
+		static std::string escapeLabel(const std::string& value)
+		{
+			std::string result;
+			for (const char c : value)
+			{
+				if (c == '\\' || c == '"')
+				{
+					result += '\\';
+				}
+				result += c == '\n' ? std::string("\\n") : std::string(1, c);
+			}
+			return result;
+		}
+		static void dumpSummary(std::ostream& os, const std::string& name, const std::string& labels, const Series& series)
+		{
+			const TimeStats stats = getTimeStats(series);
+			const std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+			os << name << prefix << "quantile=\"0.5\"} " << stats.p50 * 1e-6 << "\n"
+				<< name << prefix << "quantile=\"0.99\"} " << stats.p99 * 1e-6 << "\n"
+				<< name << prefix << "quantile=\"1\"} " << stats.max * 1e-6 << "\n"
+				<< name << "_sum" << (labels.empty() ? "" : "{" + labels + "}") << " " << series.totalMicros * 1e-6 << "\n"
+				<< name << "_count" << (labels.empty() ? "" : "{" + labels + "}") << " " << series.totalCount << "\n";
+		}
+		void dumpUnlocked(std::ostream& os) const
+		{
+			os << "# HELP volka_frame_seconds Time between the starts of consecutive frames.\n"
+				<< "# TYPE volka_frame_seconds summary\n";
+			dumpSummary(os, "volka_frame_seconds", "", frame);
+			os << "# HELP volka_frame_hitches_total Frames longer than the hitch threshold.\n"
+				<< "# TYPE volka_frame_hitches_total counter\n"
+				<< "volka_frame_hitches_total " << hitchCount << "\n"
+				<< "# HELP volka_phase_seconds Time spent in each phase of an entity manager.\n"
+				<< "# TYPE volka_phase_seconds summary\n";
+			for (const auto& slot : slots)
+			{
+				for (std::size_t i = 0; i < PhaseNum; ++i)
+				{
+					dumpSummary(os, "volka_phase_seconds",
+						"manager=\"" + escapeLabel(slot.first) + "\",phase=\"" + PhaseNames[i] + "\"", slot.second.phases[i]);
+				}
+			}
+			os << "# HELP volka_entities Live entities per entity manager.\n"
+				<< "# TYPE volka_entities gauge\n";
+			for (const auto& slot : slots)
+			{
+				os << "volka_entities{manager=\"" << escapeLabel(slot.first) << "\"} " << slot.second.counter->getEntityNum() << "\n";
+			}
+			os << "# HELP volka_components Live components per entity manager.\n"
+				<< "# TYPE volka_components gauge\n";
+			for (const auto& slot : slots)
+			{
+				os << "volka_components{manager=\"" << escapeLabel(slot.first) << "\"} " << slot.second.counter->getComponentNum() << "\n";
+			}
+			os.flush();
+		}
+	private:
+		std::map<std::string, Slot> slots;
+		Series frame;
+		std::uint64_t lastFrame = 0;
+		std::uint64_t hitchCount = 0;
+		std::uint64_t hitchThreshold = 33333;
+		std::uint64_t windowFrames = 600;
+		std::uint64_t dumpInterval = 0;
+		std::string dumpPath;
+		std::chrono::steady_clock::time_point frameStart;
+		bool started = false;
+		mutable std::mutex mutex;
+	};
+}
@@ -0,0 +1,385 @@
+//---------------------------------------------------------
+//!@file AssetPack.hpp
+//!@brief 複数のアセットを1つにまとめたパックファイルを扱います
+//!@author Volka
+//!@date 2018/11/3
+//!@note 画像は読み込み時にデコードしないように、ARGB8888 に変換済みのピクセルで格納します
+//!@note VOLKA_USE_LZ4 を定義すると LZ4 で圧縮したデータも扱えます
+//!@note 形式: ヘッダ, データ(64バイト境界), 目次(名前順), 名前の文字列
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "../Render/PixelConvert.hpp"
+#ifdef VOLKA_USE_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+//-------------------------------------------
+//!@class AssetPackHeader
+//!@brief パックファイルの先頭
+//-------------------------------------------
+struct AssetPackHeader
+{
+	static constexpr std::uint32_t MagicValue = 0x4B415056;	//"VPAK"
+	static constexpr std::uint32_t CurrentVersion = 1;
+	std::uint32_t magic = MagicValue;
+	std::uint32_t version = CurrentVersion;
+	std::uint32_t entryNum = 0;
+	std::uint32_t reserved = 0;
+	std::uint64_t tocOffset = 0;
+	std::uint64_t nameOffset = 0;
+};
+
+//-------------------------------------------
+//!@class AssetPackEntry
+//!@brief 目次の1項目
+//-------------------------------------------
+struct AssetPackEntry
+{
+	enum class Kind : std::uint32_t
+	{
+		Raw,	//そのままのバイト列
+		Image,	//ピクセル(format, width, height, pitch)
+	};
+	enum class Compression : std::uint32_t
+	{
+		None,
+		LZ4,
+	};
+	std::uint64_t nameOffset = 0;
+	std::uint32_t nameLength = 0;
+	Kind kind = Kind::Raw;
+	std::uint32_t format = 0;
+	std::uint32_t width = 0;
+	std::uint32_t height = 0;
+	std::uint32_t pitch = 0;
+	std::uint64_t offset = 0;
+	std::uint64_t storedSize = 0;
+	std::uint64_t rawSize = 0;
+	Compression compression = Compression::None;
+	std::uint32_t reserved = 0;
+};
+
+//-------------------------------------------
+//!@class AssetPack
+//!@brief パックファイルをマップして、中のアセットを取り出します
+//!@note 圧縮していないアセットはマップしたページをそのまま使うので、ファイルごとの読み込みがありません
+//-------------------------------------------
+class AssetPack final
+{
+public:
+	AssetPack() = default;
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+	//!@brief [filePath]のパックを開きます
+	//!@return true:成功  false:ファイルがない/壊れている
+	bool open(const std::string& filePath)
+	{
+		close();
+		if (!file.open(filePath))
+		{
+			return false;
+		}
+		if (file.getSize() < sizeof(AssetPackHeader))
+		{
+			close();
+			return false;
+		}
+		std::memcpy(&header, file.getData(), sizeof(header));
+		//ファイルの値を足したり掛けたりすると溢れるので、残りの大きさと比べる
+		const std::uint64_t fileSize = file.getSize();
+		if (header.magic != AssetPackHeader::MagicValue || header.version != AssetPackHeader::CurrentVersion ||
+			header.tocOffset > fileSize || header.entryNum > (fileSize - header.tocOffset) / sizeof(AssetPackEntry) ||
+			header.nameOffset > fileSize || header.tocOffset % alignof(AssetPackEntry) != 0)
+		{
+			close();
+			return false;
+		}
+		const auto* tocEntries = reinterpret_cast<const AssetPackEntry*>(file.getData() + header.tocOffset);
+		const std::uint64_t nameSize = fileSize - header.nameOffset;
+		for (std::uint32_t i = 0; i < header.entryNum; ++i)
+		{
+			const AssetPackEntry& entry = tocEntries[i];
+			if (entry.nameOffset > nameSize || entry.nameLength > nameSize - entry.nameOffset ||
+				entry.offset > fileSize || entry.storedSize > fileSize - entry.offset ||
+				(entry.compression == AssetPackEntry::Compression::None && entry.storedSize != entry.rawSize))
+			{
+				close();
+				return false;
+			}
+		}
+		entries = tocEntries;
+		return true;
+	}
+	//!@brief パックを閉じます
+	void close() noexcept
+	{
+		file.close();
+		header = AssetPackHeader();
+		entries = nullptr;
+	}
+	//!@brief 開いているか
+	[[nodiscard]] bool isOpen() const noexcept
+	{
+		return entries != nullptr;
+	}
+	//!@brief アセットの数
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return isOpen() ? header.entryNum : 0;
+	}
+	//!@brief [index]番目の項目を取得します
+	[[nodiscard]] const AssetPackEntry& getEntry(const std::size_t index) const noexcept
+	{
+		return entries[index];
+	}
+	//!@brief 項目の名前を取得します
+	[[nodiscard]] std::string getName(const AssetPackEntry& entry) const
+	{
+		return std::string(getNameData(entry), entry.nameLength);
+	}
+	//!@brief [name]の項目を探します(目次は名前順なので二分探索)
+	//!@return 見つからなければ nullptr
+	[[nodiscard]] const AssetPackEntry* find(const std::string& name) const noexcept
+	{
+		if (!isOpen())
+		{
+			return nullptr;
+		}
+		const AssetPackEntry* end = entries + header.entryNum;
+		const AssetPackEntry* itr = std::lower_bound(entries, end, name,
+			[this](const AssetPackEntry& entry, const std::string& key)
+		{
+			return compareName(entry, key) < 0;
+		});
+		if (itr == end || compareName(*itr, name) != 0)
+		{
+			return nullptr;
+		}
+		return itr;
+	}
+	//!@brief [entry]のデータを取得します
+	//!@param scratch 圧縮されているときに展開する先
+	//!@return 圧縮されていなければマップしたページ、失敗したら nullptr
+	[[nodiscard]] const std::byte* getData(const AssetPackEntry& entry, std::vector<std::byte>& scratch) const
+	{
+		const std::byte* stored = file.getData() + entry.offset;
+		switch (entry.compression)
+		{
+		case AssetPackEntry::Compression::None:
+			return stored;
+		case AssetPackEntry::Compression::LZ4:
+#ifdef VOLKA_USE_LZ4
+			if (entry.storedSize > INT_MAX || entry.rawSize > INT_MAX)
+			{
+				return nullptr;
+			}
+			scratch.resize(static_cast<std::size_t>(entry.rawSize));
+			if (LZ4_decompress_safe(reinterpret_cast<const char*>(stored), reinterpret_cast<char*>(scratch.data()),
+				static_cast<int>(entry.storedSize), static_cast<int>(entry.rawSize)) != static_cast<int>(entry.rawSize))
+			{
+				return nullptr;
+			}
+			return scratch.data();
+#else
+			(void)scratch;
+			return nullptr;
+#endif
+		}
+		return nullptr;
+	}
+	//!@brief [name]の画像から texture を作ります
+	//!@param premultiply true なら色にアルファを掛けてから転送します(Render::PremultiplyAlpha)
+	//!@return 見つからない/画像でない/失敗したら nullptr
+	[[nodiscard]] SDL_Texture* createTexture(SDL_Renderer* renderer, const std::string& name, const bool premultiply = false)
+	{
+		const AssetPackEntry* entry = find(name);
+		if (entry == nullptr || entry->kind != AssetPackEntry::Kind::Image || entry->format != Render::TextureFormat ||
+			!isValidImage(*entry))
+		{
+			return nullptr;
+		}
+		const std::byte* pixels = getData(*entry, scratch);
+		if (pixels == nullptr)
+		{
+			return nullptr;
+		}
+		if (premultiply)
+		{
+			//マップしたページは読み取り専用なので、展開先にコピーしてから掛ける
+			const std::size_t size = static_cast<std::size_t>(entry->pitch) * entry->height;
+			if (pixels != scratch.data())
+			{
+				scratch.assign(pixels, pixels + size);
+			}
+			for (std::uint32_t y = 0; y < entry->height; ++y)
+			{
+				auto* row = reinterpret_cast<std::uint32_t*>(scratch.data() + static_cast<std::size_t>(entry->pitch) * y);
+				Render::PremultiplyAlpha(row, row, entry->width);
+			}
+			pixels = scratch.data();
+		}
+		return Render::CreateTexture(renderer, pixels, static_cast<int>(entry->width), static_cast<int>(entry->height),
+			static_cast<int>(entry->pitch), premultiply);
+	}
+private:
+	//!@brief 画像の大きさと1行のバイト数が、展開後のデータに収まっているか
+	//!@note pitch >= width * 4 と pitch * height <= rawSize を、掛け算が溢れないように割って確かめる
+	[[nodiscard]] static bool isValidImage(const AssetPackEntry& entry) noexcept
+	{
+		constexpr std::uint32_t BytesPerPixel = 4;
+		return entry.width != 0 && entry.height != 0 &&
+			entry.pitch <= INT_MAX && entry.width <= INT_MAX && entry.height <= INT_MAX &&
+			entry.width <= entry.pitch / BytesPerPixel &&
+			entry.height <= entry.rawSize / entry.pitch;
+	}
+	[[nodiscard]] const char* getNameData(const AssetPackEntry& entry) const noexcept
+	{
+		return reinterpret_cast<const char*>(file.getData() + header.nameOffset + entry.nameOffset);
+	}
+	[[nodiscard]] int compareName(const AssetPackEntry& entry, const std::string& name) const noexcept
+	{
+		const std::size_t length = std::min<std::size_t>(entry.nameLength, name.size());
+		const int result = std::memcmp(getNameData(entry), name.data(), length);
+		if (result != 0)
+		{
+			return result;
+		}
+		return entry.nameLength < name.size() ? -1 : (entry.nameLength > name.size() ? 1 : 0);
+	}
+private:
+	MappedFile file;
+	AssetPackHeader header;
+	const AssetPackEntry* entries = nullptr;
+	std::vector<std::byte> scratch;
+};
+
+//-------------------------------------------
+//!@class AssetPackWriter
+//!@brief パックファイルを作ります(パッカーで使います)
+//-------------------------------------------
+class AssetPackWriter final
+{
+public:
+	static constexpr std::size_t DataAlignment = 64;
+public:
+	//!@brief [name]としてバイト列を追加します
+	void addRaw(const std::string& name, const void* data, const std::size_t size)
+	{
+		AssetPackEntry entry;
+		entry.kind = AssetPackEntry::Kind::Raw;
+		add(name, entry, data, size);
+	}
+	//!@brief [name]として[format]のピクセルを追加します
+	void addImage(const std::string& name, const std::uint32_t format, const int width, const int height, const int pitch, const void* pixels)
+	{
+		AssetPackEntry entry;
+		entry.kind = AssetPackEntry::Kind::Image;
+		entry.format = format;
+		entry.width = static_cast<std::uint32_t>(width);
+		entry.height = static_cast<std::uint32_t>(height);
+		entry.pitch = static_cast<std::uint32_t>(pitch);
+		add(name, entry, pixels, static_cast<std::size_t>(pitch) * static_cast<std::size_t>(height));
+	}
+	//!@brief LZ4 で圧縮するか設定します(小さくならないものは圧縮しません)
+	//!@note VOLKA_USE_LZ4 がなければ無視されます
+	void setCompression(const bool enable) noexcept
+	{
+		compress = enable;
+	}
+	//!@brief [filePath]へ書き出します
+	//!@return true:成功  false:失敗
+	bool write(const std::string& filePath)
+	{
+		std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.name < b.name; });
+		for (std::size_t i = 1; i < items.size(); ++i)
+		{
+			if (items[i - 1].name == items[i].name)
+			{
+				return false;
+			}
+		}
+		std::vector<std::byte> image(sizeof(AssetPackHeader));
+		std::vector<AssetPackEntry> toc;
+		std::string names;
+		for (auto& item : items)
+		{
+			image.resize(AlignUp(image.size(), DataAlignment));
+			item.entry.offset = image.size();
+			item.entry.nameOffset = names.size();
+			item.entry.nameLength = static_cast<std::uint32_t>(item.name.size());
+			image.insert(image.end(), item.data.begin(), item.data.end());
+			names += item.name;
+			toc.emplace_back(item.entry);
+		}
+		AssetPackHeader header;
+		header.entryNum = static_cast<std::uint32_t>(toc.size());
+		image.resize(AlignUp(image.size(), alignof(AssetPackEntry)));
+		header.tocOffset = image.size();
+		const std::size_t tocBytes = toc.size() * sizeof(AssetPackEntry);
+		image.resize(image.size() + tocBytes);
+		if (tocBytes != 0)
+		{
+			std::memcpy(image.data() + header.tocOffset, toc.data(), tocBytes);
+		}
+		header.nameOffset = image.size();
+		image.resize(image.size() + names.size());
+		std::memcpy(image.data() + header.nameOffset, names.data(), names.size());
+		std::memcpy(image.data(), &header, sizeof(header));
+		std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+		return static_cast<bool>(out);
+	}
+private:
+	struct Item
+	{
+		std::string name;
+		AssetPackEntry entry;
+		std::vector<std::byte> data;
+	};
+	static std::size_t AlignUp(const std::size_t value, const std::size_t alignment) noexcept
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+	void add(const std::string& name, AssetPackEntry& entry, const void* data, const std::size_t size)
+	{
+		Item item;
+		item.name = name;
+		entry.rawSize = size;
+		entry.storedSize = size;
+		entry.compression = AssetPackEntry::Compression::None;
+		const auto* bytes = static_cast<const std::byte*>(data);
+#ifdef VOLKA_USE_LZ4
+		if (compress && size > 0)
+		{
+			item.data.resize(static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(size))));
+			const int compressed = LZ4_compress_HC(static_cast<const char*>(data), reinterpret_cast<char*>(item.data.data()),
+				static_cast<int>(size), static_cast<int>(item.data.size()), LZ4HC_CLEVEL_DEFAULT);
+			if (compressed > 0 && static_cast<std::size_t>(compressed) < size)
+			{
+				item.data.resize(static_cast<std::size_t>(compressed));
+				entry.storedSize = item.data.size();
+				entry.compression = AssetPackEntry::Compression::LZ4;
+				item.entry = entry;
+				items.emplace_back(std::move(item));
+				return;
+			}
+		}
+#endif
+		item.data.assign(bytes, bytes + size);
+		item.entry = entry;
+		items.emplace_back(std::move(item));
+	}
+private:
+	std::vector<Item> items;
+	bool compress = false;
+};
@@ -0,0 +1,151 @@
+//---------------------------------------------------------
+//!@file FileWatcher.hpp
+//!@brief ファイルの変更を監視します
+//!@author Volka
+//!@date 2018/11/3
+//!@note Linux は inotify でディレクトリを監視し、それ以外は更新日時を一定間隔で調べます
+//!@note poll() はブロックしないので、毎フレーム呼んでも構いません
+//---------------------------------------------------------
+#pragma once
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define VOLKA_FILEWATCH_INOTIFY
+#endif
+
+//-------------------------------------------
+//!@class FileWatcher
+//!@brief 登録したファイルが書き換えられたら poll() で返します
+//-------------------------------------------
+class FileWatcher final
+{
+public:
+	//!@param interval 更新日時を調べる間隔(poll() の回数、inotify のときは使いません)
+	explicit FileWatcher(const unsigned interval = 30) noexcept
+		: pollInterval(interval == 0 ? 1 : interval)
+	{
+#ifdef VOLKA_FILEWATCH_INOTIFY
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	}
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+	~FileWatcher()
+	{
+#ifdef VOLKA_FILEWATCH_INOTIFY
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+#endif
+	}
+	//!@brief [filePath]を監視します
+	void watch(const std::string& filePath)
+	{
+		if (files.find(filePath) != files.end())
+		{
+			return;
+		}
+		files[filePath] = getWriteTime(filePath);
+#ifdef VOLKA_FILEWATCH_INOTIFY
+		const std::string directory = getDirectory(filePath);
+		if (fd >= 0 && std::find_if(directories.begin(), directories.end(),
+			[&directory](const auto& d) { return d.second == directory; }) == directories.end())
+		{
+			const int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (wd >= 0)
+			{
+				directories[wd] = directory;
+			}
+		}
+#endif
+	}
+	//!@brief [filePath]の監視をやめます(ディレクトリの監視は残ります)
+	void unwatch(const std::string& filePath)
+	{
+		files.erase(filePath);
+	}
+	//!@brief 前回から変更されたファイルを[changed]に入れます(重複なし)
+	void poll(std::vector<std::string>& changed)
+	{
+		changed.clear();
+#ifdef VOLKA_FILEWATCH_INOTIFY
+		if (fd >= 0)
+		{
+			pollNotify(changed);
+			return;
+		}
+#endif
+		if (++pollCount % pollInterval != 0)
+		{
+			return;
+		}
+		for (auto& file : files)
+		{
+			const auto time = getWriteTime(file.first);
+			if (time != file.second)
+			{
+				file.second = time;
+				changed.emplace_back(file.first);
+			}
+		}
+	}
+private:
+	using WriteTime = std::filesystem::file_time_type;
+	static WriteTime getWriteTime(const std::string& filePath)
+	{
+		std::error_code error;
+		const auto time = std::filesystem::last_write_time(filePath, error);
+		return error ? WriteTime::min() : time;
+	}
+#ifdef VOLKA_FILEWATCH_INOTIFY
+	static std::string getDirectory(const std::string& filePath)
+	{
+		const std::size_t slash = filePath.find_last_of("/\\");
+		return slash == std::string::npos ? std::string(".") : filePath.substr(0, slash);
+	}
+	void pollNotify(std::vector<std::string>& changed)
+	{
+		alignas(inotify_event) char buffer[4096];
+		for (;;)
+		{
+			const ssize_t length = read(fd, buffer, sizeof(buffer));
+			if (length <= 0)
+			{
+				break;
+			}
+			for (ssize_t offset = 0; offset < length;)
+			{
+				const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+				const auto directory = directories.find(event->wd);
+				if (event->len == 0 || directory == directories.end())
+				{
+					continue;
+				}
+				const std::string name(event->name);
+				const std::string filePath = directory->second == "." ? name : directory->second + "/" + name;
+				if (files.find(filePath) != files.end() &&
+					std::find(changed.begin(), changed.end(), filePath) == changed.end())
+				{
+					changed.emplace_back(filePath);
+				}
+			}
+		}
+	}
+	int fd = -1;
+	std::unordered_map<int, std::string> directories;
+#endif
+	std::unordered_map<std::string, WriteTime> files;
+	unsigned pollInterval;
+	unsigned pollCount = 0;
+};
@@ -0,0 +1,138 @@
+//---------------------------------------------------------
+//!@file MappedFile.hpp
+//!@brief ファイルを読み込み専用でメモリにマップします
+//!@author Volka
+//!@date 2018/11/3
+//!@note Windows は MapViewOfFile、それ以外は mmap を使います
+//---------------------------------------------------------
+#pragma once
+#include <cstddef>
+#include <string>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//-------------------------------------------
+//!@class MappedFile
+//!@brief ファイル全体を読み込み専用でマップします
+//-------------------------------------------
+class MappedFile final
+{
+public:
+	MappedFile() noexcept = default;
+	explicit MappedFile(const std::string& filePath) noexcept
+	{
+		open(filePath);
+	}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile()
+	{
+		close();
+	}
+	//!@brief [filePath]をマップします
+	//!@return true:成功  false:失敗
+	bool open(const std::string& filePath) noexcept
+	{
+		close();
+#ifdef _WIN32
+		file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			close();
+			return false;
+		}
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			close();
+			return false;
+		}
+		data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+		file = ::open(filePath.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			return false;
+		}
+		struct stat fileStat;
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			close();
+			return false;
+		}
+		void* mapped = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapped == MAP_FAILED)
+		{
+			close();
+			return false;
+		}
+		data = static_cast<const std::byte*>(mapped);
+		size = static_cast<std::size_t>(fileStat.st_size);
+#endif
+		if (data == nullptr)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+	//!@brief マップを解除します
+	void close() noexcept
+	{
+#ifdef _WIN32
+		if (data != nullptr) { UnmapViewOfFile(data); }
+		if (mapping != nullptr) { CloseHandle(mapping); }
+		if (file != INVALID_HANDLE_VALUE) { CloseHandle(file); }
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data != nullptr) { munmap(const_cast<std::byte*>(data), size); }
+		if (file >= 0) { ::close(file); }
+		file = -1;
+#endif
+		data = nullptr;
+		size = 0;
+	}
+	//!@brief マップできているかどうか
+	[[nodiscard]] bool isOpen() const noexcept
+	{
+		return data != nullptr;
+	}
+	//!@brief 先頭のアドレスを取得します
+	[[nodiscard]] const std::byte* getData() const noexcept
+	{
+		return data;
+	}
+	//!@brief ファイルのサイズを取得します
+	[[nodiscard]] std::size_t getSize() const noexcept
+	{
+		return size;
+	}
+private:
+	const std::byte* data = nullptr;
+	std::size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int file = -1;
+#endif
+};
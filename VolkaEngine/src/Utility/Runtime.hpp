@@ -0,0 +1,121 @@
+//---------------------------------------------------------
+//!@file Runtime.hpp
+//!@brief 実行モード(ウィンドウあり/ヘッドレス)とシミュレーションの時間を扱います
+//!@author Volka
+//!@date 2018/11/3
+//!@note ヘッドレスではウィンドウを作らず、描画(draw2D/draw3D)を行わず、固定の時間刻みでできるだけ速く更新します
+//!@note サーバーや CI でのボット・リプレイ・負荷試験に使います
+//---------------------------------------------------------
+#pragma once
+#include <SDL.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+//-------------------------------------------
+//!@class Runtime
+//!@brief 実行モードと、フレームごとに固定の刻みで進む時間を管理します
+//!@note モードは WindowSystem を追加する前に設定してください
+//-------------------------------------------
+class Runtime final
+{
+public:
+	enum class Mode
+	{
+		Windowed,	//ウィンドウを作って描画する
+		Headless,	//ウィンドウも描画もなしで、シミュレーションだけを行う
+	};
+public:
+	Runtime(const Runtime&) = delete;
+	Runtime& operator=(const Runtime&) = delete;
+	//!@brief 実行モードを設定します
+	void setMode(const Mode runMode) noexcept
+	{
+		mode = runMode;
+	}
+	[[nodiscard]] Mode getMode() const noexcept
+	{
+		return mode;
+	}
+	[[nodiscard]] bool isHeadless() const noexcept
+	{
+		return mode == Mode::Headless;
+	}
+	//!@brief 1フレームで進める時間[秒]を設定します
+	void setTimeStep(const double seconds) noexcept
+	{
+		timeStep = seconds > 0.0 ? seconds : timeStep;
+	}
+	[[nodiscard]] double getTimeStep() const noexcept
+	{
+		return timeStep;
+	}
+	//!@brief [frames]フレーム更新したら isFinished() を true にします(0で無制限)
+	void setMaxFrames(const std::uint64_t frames) noexcept
+	{
+		maxFrames = frames;
+	}
+	[[nodiscard]] bool isFinished() const noexcept
+	{
+		return maxFrames != 0 && frameCount >= maxFrames;
+	}
+	//!@brief 時間を1フレーム進めます(EntitySystemManager::update() から呼ばれます)
+	void advance() noexcept
+	{
+		++frameCount;
+	}
+	//!@brief 更新したフレーム数
+	[[nodiscard]] std::uint64_t getFrameCount() const noexcept
+	{
+		return frameCount;
+	}
+	//!@brief シミュレーションの経過時間[秒](フレーム数 × 時間刻み)
+	[[nodiscard]] double getTime() const noexcept
+	{
+		return static_cast<double>(frameCount) * timeStep;
+	}
+	//!@brief SDL_GetTicks() の代わりに使う時刻[ms]
+	//!@note ヘッドレスではシミュレーションの時間を返すので、実行速度によらず同じ結果になります
+	[[nodiscard]] Uint32 getTicks() const noexcept
+	{
+		if (isHeadless())
+		{
+			return static_cast<Uint32>(getTime() * 1000.0);
+		}
+		return SDL_GetTicks();
+	}
+	//!@brief コマンドライン引数を読みます
+	//!@note --headless  ヘッドレスで実行する
+	//!@note --frames <N>  Nフレーム更新したら終わる
+	//!@note --timestep <秒>  1フレームで進める時間
+	void parseArgs(const int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			if (arg == "--headless")
+			{
+				setMode(Mode::Headless);
+			}
+			else if (arg == "--frames" && i + 1 < argc)
+			{
+				setMaxFrames(std::strtoull(argv[++i], nullptr, 10));
+			}
+			else if (arg == "--timestep" && i + 1 < argc)
+			{
+				setTimeStep(std::strtod(argv[++i], nullptr));
+			}
+		}
+	}
+	[[nodiscard]] static Runtime& get() noexcept
+	{
+		static Runtime runtime;
+		return runtime;
+	}
+private:
+	Runtime() = default;
+	Mode mode = Mode::Windowed;
+	double timeStep = 1.0 / 60.0;
+	std::uint64_t frameCount = 0;
+	std::uint64_t maxFrames = 0;
+};
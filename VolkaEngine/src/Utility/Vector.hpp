@@ -1,10 +1,10 @@
 //---------------------------------------------------------
 //!@file Vector.hpp
-//!@brief Vector܂
+//!@brief Vectorを扱います
 //!@author Volka
 //!@date 2018/11/3
-//!@note Vector2Type,Vector3,Vector4Type@Ȃ
-//!@note QlURL https://github.com/tonarinohito/MyGameTemplate/blob/master/gameTemple/src/Utility/Vec.hpp 
+//!@note Vector2Type,Vector3,Vector4Type　など
+//!@note 参考URL https://github.com/tonarinohito/MyGameTemplate/blob/master/gameTemple/src/Utility/Vec.hpp 
 //!@note by tonarinohito
 //---------------------------------------------------------
 #pragma once
@@ -13,7 +13,7 @@
 
 //-------------------------------------------
 //!@class Vector2Type
-//!@brief 2xNg܂
+//!@brief 2次元ベクトルを扱います
 //-------------------------------------------
 template<typename Type>
 class Vector2Type
@@ -28,58 +28,58 @@ public:
 	explicit Vector2Type(const Vector2Type& vector2) noexcept
 		: xValue(vector2.xValue), yValue(vector2.yValue)
 	{}
-	virtual ~Vector2Type() = default;
-	//!@brief@ItZbgl̃Rs[擾܂
+	~Vector2Type() = default;
+	//!@brief　オフセットした値のコピーを取得します
 	[[nodiscard]] const Vector2Type offsetCopy(const Type offsetX, const Type offsetY) const noexcept
 	{
 		return Vector2Type( xValue + offsetX,yValue + offsetY );
 	}
-	//!@brief@ItZbgl擾܂
+	//!@brief　オフセットした値を取得します
 	[[noreturn]] void offset(const Type offsetX, const Type offsetY) const noexcept
 	{
 		xValue += offsetX;
 		yValue += offsetY;
 		return *this;
 	}
-	//!@brief l0ɂ܂
+	//!@brief 値を0にします
 	[[noreturn]] void zero() const noexcept
 	{
 		xValue = 0;
 		yValue = 0;
 	}
-	//!@brief ς擾܂
+	//!@brief 内積を取得します
 	[[nodiscard]] const Type dot(const Vector2Type& vector2) const noexcept
 	{
 		return xValue * vector2.xValue + yValue * vector2.yValue;
 	}
-	//!@brief ς擾܂
+	//!@brief 内積を取得します
 	[[nodiscard]] static Type dot(const Vector2Type& v1, const Vector2Type& v2) noexcept
 	{
 		return v1.xValue * v2.xValue + v1.yValue * v2.yValue;
 	}
-	//!@brief Oς擾܂
+	//!@brief 外積を取得します
 	[[nodiscard]] const Type closs(const Vector2Type& vector2) const noexcept
 	{
 		return xValue * vector2.yValue - vector2.xValue * yValue;
 	}
-	//!@brief Oς擾܂
+	//!@brief 外積を取得します
 	[[nodiscard]] static Type closs(const Vector2Type& v1, const Vector2Type& v2) noexcept
 	{
 		return v1.xValue * v2.yValue - v2.xValue * v1.yValue;
 	}
-	//!@brief 2_Ԃ̋擾܂
+	//!@brief 2点間の距離を取得します
 	[[nodiscard]] const Type getDistance(const Vector2Type& vector2) const noexcept
 	{
 		const Type xDistance = xValue - vector2.xValue;
 		const Type yDistance = yValue - vector2.yValue;
 		return sqrtf(xDistance * xDistance + yDistance * yDistance);
 	}
-	//!@brief 擾܂
+	//!@brief 長さを取得します
 	[[nodiscard]] const Type length() const noexcept
 	{
 		return sqrtf(xValue * xValue + yValue * yValue);
 	}
-	//!@brief g𐳋Kl擾܂
+	//!@brief 自身を正規化した値を取得します
 	[[nodiscard]] const Type& nomalize() const noexcept
 	{
 		Type len = length();
@@ -87,7 +87,7 @@ public:
 		yValue /= len;
 		return *this;
 	}
-	//!@brief Kl̃Rs[擾܂
+	//!@brief 正規化した値のコピーを取得します
 	[[nodiscard]] const Type nomalized() const noexcept
 	{
 		Type len = length();
@@ -120,12 +120,12 @@ public:
 	}
 	[[nodiscard]] Vector2Type operator/(const Vector2Type& vector2) const noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0) { throw std::exception("0除算を行いました"); }
 		return Vector2Type( xValue / vector2.xValue,yValue / vector2.yValue );
 	}
 	[[nodiscard]] Vector2Type operator/(const Type& scale) const noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0) { throw std::exception("0除算を行いました"); }
 		return Vector2Type( xValue / scale,yValue / scale );
 	}
 	[[noreturn]] void operator=(const Vector2Type& vector2) noexcept
@@ -155,7 +155,7 @@ public:
 	}
 	[[noreturn]] void operator/=(const Vector2Type& vector2) noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0) { throw std::exception("0除算を行いました"); }
 		xValue /= vector2.xValue;
 		yValue /= vector2.yValue;
 	}
@@ -180,13 +180,13 @@ public:
 using Vector2Int = Vector2Type<int>;
 using Vector2Float = Vector2Type<float>;
 using Vector2Double = Vector2Type<double>;
-//ftHgfloat^
+//デフォルトでfloat型
 using Vector2 = Vector2Float;
 
 
 //-------------------------------------------
 //!@class Vector3
-//!@brief 3xNg܂
+//!@brief 3次元ベクトルを扱います
 //-------------------------------------------
 template<typename Type>
 class Vector3Type
@@ -201,51 +201,51 @@ public:
 	Vector3Type(const Vector3Type& vector3) noexcept
 		: xValue(vector3.xValue), yValue(vector3.yValue),zValue(vector3.zValue)
 	{}
-	virtual ~Vector3Type() = default;
-	//!@brief@ItZbgl̃Rs[擾܂
+	~Vector3Type() = default;
+	//!@brief　オフセットした値のコピーを取得します
 	[[nodiscard]] const Vector3Type offsetCopy(const Type offsetX, const Type offsetY,const Type offsetZ) const noexcept
 	{
 		return Vector3Type( xValue + offsetX,yValue + offsetY ,zValue + offsetZ );
 	}
-	//!@brief@ItZbgl擾܂
+	//!@brief　オフセットした値を取得します
 	[[noreturn]] void offset(const Type offsetX, const Type offsetY,const Type offsetZ) noexcept
 	{
 		xValue += offsetX;
 		yValue += offsetY;
 		zValue += offsetZ;
 	}
-	//!@brief l0ɂ܂
+	//!@brief 値を0にします
 	[[noreturn]] void zero() const noexcept
 	{
 		xValue = 0;
 		yValue = 0;
 		zValue = 0;
 	}
-	//!@brief ς擾܂
+	//!@brief 内積を取得します
 	[[nodiscard]] const Type dot(const Vector3Type& vector3) const noexcept
 	{
 		return xValue * vector3.xValue + yValue * vector3.yValue + zValue * vector3.zValue;;
 	}
-	//!@brief ς擾܂
+	//!@brief 内積を取得します
 	[[nodiscard]] static Type dot(const Vector3Type& v1, const Vector3Type& v2) noexcept
 	{
 		return v1.xValue * v2.xValue + v1.yValue * v2.yValue + v1.zValue * v2.zValue;
 	}
-	//!@brief Oς擾܂
+	//!@brief 外積を取得します
 	[[nodiscard]] const Vector3Type closs(const Vector3Type& vector3) const noexcept
 	{
 		return Vector3Type( yValue * vector3.zValue - zValue * vector3.yValue,
 				 zValue * vector3.xValue - xValue * vector3.zValue,
 				 xValue * vector3.yValue - yValue * vector3.xValue );
 	}
-	//!@brief Oς擾܂
+	//!@brief 外積を取得します
 	[[nodiscard]] static Vector3Type closs(const Vector3Type& v1, const Vector3Type& v2) noexcept
 	{
 		return Vector3Type( v1.yValue * v2.zValue - v1.zValue * v2.yValue,
 				 v1.zValue * v2.xValue - v1.xValue * v2.zValue,
 				 v1.xValue * v2.yValue - v1.yValue * v2.xValue );
 	}
-	//!@brief 2_Ԃ̋擾܂
+	//!@brief 2点間の距離を取得します
 	[[nodiscard]] const Type getDistance(const Vector3Type& vector3) const noexcept
 	{
 		const Type xDistance = xValue - vector3.xValue;
@@ -253,12 +253,12 @@ public:
 		const Type zDistance = zValue - vector3.zValue;
 		return sqrtf(xDistance * xDistance + yDistance * yDistance + zDistance * zDistance);
 	}
-	//!@brief 擾܂
+	//!@brief 長さを取得します
 	[[nodiscard]] const Type length() const noexcept
 	{
 		return sqrtf(xValue * xValue + yValue * yValue,zValue * zValue);
 	}
-	//!@brief g𐳋Kl擾܂
+	//!@brief 自身を正規化した値を取得します
 	[[nodiscard]] const Type& nomalize() noexcept
 	{
 		Type len = length();
@@ -267,7 +267,7 @@ public:
 		zValue /= len;
 		return *this;
 	}
-	//!@brief Kl̃Rs[擾܂
+	//!@brief 正規化した値のコピーを取得します
 	[[nodiscard]] const Type nomalized() const noexcept
 	{
 		Type len = length();
@@ -300,12 +300,12 @@ public:
 	}
 	[[nodiscard]] Vector3Type operator/(const Vector3Type& vector3) const noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0 || zValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0 || zValue == 0) { throw std::exception("0除算を行いました"); }
 		return Vector3Type( xValue / vector3.xValue,yValue / vector3.yValue,zValue / vector3.zValue );
 	}
 	[[nodiscard]] Vector3Type operator/(const Type& scale) const noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0 || zValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0 || zValue == 0) { throw std::exception("0除算を行いました"); }
 		return Vector3Type( xValue / scale,yValue / scale ,zValue / scale );
 	}
 	[[noreturn]] void operator=(const Vector3Type& vector3) noexcept
@@ -340,7 +340,7 @@ public:
 	}
 	[[noreturn]] void operator/=(const Vector3Type& vector3) noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0 || zValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0 || zValue == 0) { throw std::exception("0除算を行いました"); }
 		xValue /= vector3.xValue;
 		yValue /= vector3.yValue;
 		zValue /= vector3.zValue;
@@ -368,13 +368,13 @@ public:
 using Vector3Int = Vector3Type<int>;
 using Vector3Float = Vector3Type<float>;
 using Vector3Double = Vector3Type<double>;
-//ftHgfloat^
+//デフォルトでfloat型
 using Vector3 = Vector3Float;
 
 
 //-------------------------------------------
 //!@class Vector4Type
-//!@brief 4xNg܂
+//!@brief 4次元ベクトルを扱います
 //-------------------------------------------
 template<typename Type>
 class Vector4Type
@@ -392,13 +392,13 @@ public:
 	Vector4Type(const Vector3Type<Type>& vector3, const Type w = 0) noexcept
 		: xValue(vector3.xValue), yValue(vector3.yValue), zValue(vector3.zValue), wValue(w) 
 	{}
-	virtual ~Vector4Type() = default;
-	//!@brief@ItZbgl̃Rs[擾܂
+	~Vector4Type() = default;
+	//!@brief　オフセットした値のコピーを取得します
 	[[nodiscard]] const Vector4Type offsetCopy(const Type offsetX, const Type offsetY, const Type offsetZ,const Type offsetW) const noexcept
 	{
 		return Vector4Type( xValue + offsetX,yValue + offsetY ,zValue + offsetZ ,wValue = offsetW );
 	}
-	//!@brief@ItZbgl擾܂
+	//!@brief　オフセットした値を取得します
 	[[nodiscard]] const Vector4Type& offset(const Type offsetX, const Type offsetY, const Type offsetZ,const Type offsetW) const noexcept
 	{
 		xValue += offsetX;
@@ -407,7 +407,7 @@ public:
 		wValue += offsetW;
 		return *this;
 	}
-	//!@brief l0ɂ܂
+	//!@brief 値を0にします
 	[[noreturn]] void zero() const noexcept
 	{
 		xValue = 0;
@@ -415,31 +415,31 @@ public:
 		zValue = 0;
 		wValue = 0;
 	}
-	//!@brief ς擾܂
+	//!@brief 内積を取得します
 	[[nodiscard]] const Type dot(const Vector3Type<Type>& vector3) const noexcept
 	{
 		return xValue * vector3.xValue + yValue * vector3.yValue + zValue * vector3.zValue;
 	}
-	//!@brief ς擾܂
+	//!@brief 内積を取得します
 	[[nodiscard]] static Type dot(const Vector3Type<Type>& v1, const Vector3Type<Type>& v2) noexcept
 	{
 		return v1.xValue * v2.xValue + v1.yValue * v2.yValue + v1.zValue * v2.zValue;
 	}
-	//!@brief Oς擾܂
+	//!@brief 外積を取得します
 	[[nodiscard]] const Vector3Type<Type> closs(const Vector3Type<Type>& vector3) const noexcept
 	{
 		return Vector3Type<Type>( yValue * vector3.zValue - zValue * vector3.yValue,
 				 zValue * vector3.xValue - xValue * vector3.zValue,
 				 xValue * vector3.yValue - yValue * vector3.xValue );
 	}
-	//!@brief Oς擾܂
+	//!@brief 外積を取得します
 	[[nodiscard]] static Vector3Type<Type> closs(const Vector3Type<Type>& v1, const Vector3Type<Type>& v2) noexcept
 	{
 		return Vector3Type<Type>( v1.yValue * v2.zValue - v1.zValue * v2.yValue,
 				 v1.zValue * v2.xValue - v1.xValue * v2.zValue,
 				 v1.xValue * v2.yValue - v1.yValue * v2.xValue );
 	}
-	//!@brief 2_Ԃ̋擾܂
+	//!@brief 2点間の距離を取得します
 	[[nodiscard]] const Type getDistance(const Vector3Type<Type>& vector3) const noexcept
 	{
 		const Type xDistance = xValue - vector3.xValue;
@@ -447,12 +447,12 @@ public:
 		const Type zDistance = zValue - vector3.zValue;
 		return sqrtf(xDistance * xDistance + yDistance * yDistance + zDistance * zDistance);
 	}
-	//!@brief 擾܂
+	//!@brief 長さを取得します
 	[[nodiscard]] const Type length() const noexcept
 	{
 		return sqrtf(xValue * xValue + yValue * yValue, zValue * zValue);
 	}
-	//!@brief g𐳋Kl擾܂
+	//!@brief 自身を正規化した値を取得します
 	[[nodiscard]] const Vector4Type& nomalize() const noexcept
 	{
 		Type len = length();
@@ -461,7 +461,7 @@ public:
 		zValue /= len;
 		return *this;
 	}
-	//!@brief Kl̃Rs[擾܂
+	//!@brief 正規化した値のコピーを取得します
 	[[nodiscard]] const Vector4Type nomalized() const noexcept
 	{
 		Type len = length();
@@ -494,12 +494,12 @@ public:
 	}
 	[[nodiscard]] Vector4Type operator/(const Vector4Type& vector4) const noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0 || zValue == 0 || wValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0 || zValue == 0 || wValue == 0) { throw std::exception("0除算を行いました"); }
 		return Vector4Type( xValue / vector4.xValue,yValue / vector4.yValue,zValue / vector4.zValue ,wValue / vector4.wValue );
 	}
 	[[nodiscard]] Vector4Type operator/(const Type& scale) const noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0 || zValue == 0 || wValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0 || zValue == 0 || wValue == 0) { throw std::exception("0除算を行いました"); }
 		return Vector4Type( xValue / scale,yValue / scale ,zValue / scale , wValue / scale );
 	}
 	[[noreturn]] void operator=(const Vector4Type& vector4) noexcept
@@ -539,7 +539,7 @@ public:
 	}
 	[[noreturn]] void operator/=(const Vector4Type& vector4) noexcept(false)
 	{
-		if (xValue == 0 || yValue == 0 || zValue == 0 || wValue == 0) { throw std::exception("0Zs܂"); }
+		if (xValue == 0 || yValue == 0 || zValue == 0 || wValue == 0) { throw std::exception("0除算を行いました"); }
 		xValue /= vector4.xValue;
 		yValue /= vector4.yValue;
 		zValue /= vector4.zValue;
@@ -571,7 +571,7 @@ public:
 using Vector4Int = Vector4Type<int>;
 using Vector4Float = Vector4Type<float>;
 using Vector4Double = Vector4Type<double>;
-//ftHgfloat^
+//デフォルトでfloat型
 using Vector4 = Vector4Float;
 
 
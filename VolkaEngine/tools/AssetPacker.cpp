@@ -0,0 +1,116 @@
+//---------------------------------------------------------
+//!@file AssetPacker.cpp
+//!@brief アセットをパックファイル(AssetPack)にまとめるツール
+//!@author Volka
+//!@date 2018/11/3
+//!@note 使い方: AssetPacker [--lz4] <出力.vpak> <ファイル>...
+//!@note 画像は SDL_image でデコードして ARGB8888 に変換し、それ以外はそのまま格納します
+//!@note 名前は引数に書いたパスのまま(区切りは / )なので、エンジンから読むときと同じパスで指定してください
+//!@note エンジンとは別の実行ファイルとしてビルドします(--lz4 には VOLKA_USE_LZ4 と liblz4 が必要)
+//---------------------------------------------------------
+#pragma comment(lib, "SDL2.lib")
+#pragma comment(lib, "SDL2_image.lib")
+#include <SDL.h>
+#include <SDL2_image/SDL_image.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../src/Render/PixelConvert.hpp"
+#include "../src/Utility/AssetPack.hpp"
+
+namespace
+{
+	//!@brief 画像として扱う拡張子か
+	bool IsImage(std::string filePath)
+	{
+		std::transform(filePath.begin(), filePath.end(), filePath.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		for (const char* ext : { ".png", ".bmp", ".jpg", ".jpeg", ".tga", ".gif", ".tif", ".tiff", ".webp" })
+		{
+			const std::size_t length = std::strlen(ext);
+			if (filePath.size() >= length && filePath.compare(filePath.size() - length, length, ext) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	//!@brief 画像を ARGB8888 にしてパックに追加します
+	bool AddImage(AssetPackWriter& writer, const std::string& name, const std::string& filePath)
+	{
+		SDL_Surface* loadSurface = IMG_Load(filePath.c_str());
+		if (loadSurface == nullptr)
+		{
+			std::cerr << filePath << ": " << IMG_GetError() << std::endl;
+			return false;
+		}
+		SDL_Surface* surface = Render::NormalizeSurface(loadSurface, false);
+		SDL_FreeSurface(loadSurface);
+		if (surface == nullptr)
+		{
+			std::cerr << filePath << ": " << SDL_GetError() << std::endl;
+			return false;
+		}
+		SDL_LockSurface(surface);
+		writer.addImage(name, Render::TextureFormat, surface->w, surface->h, surface->pitch, surface->pixels);
+		SDL_UnlockSurface(surface);
+		SDL_FreeSurface(surface);
+		return true;
+	}
+	//!@brief ファイルをそのままパックに追加します
+	bool AddRaw(AssetPackWriter& writer, const std::string& name, const std::string& filePath)
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file)
+		{
+			std::cerr << filePath << ": cannot open" << std::endl;
+			return false;
+		}
+		const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		writer.addRaw(name, data.data(), data.size());
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	AssetPackWriter writer;
+	if (!args.empty() && args.front() == "--lz4")
+	{
+#ifndef VOLKA_USE_LZ4
+		std::cerr << "--lz4: built without VOLKA_USE_LZ4" << std::endl;
+		return 1;
+#endif
+		writer.setCompression(true);
+		args.erase(args.begin());
+	}
+	if (args.size() < 2)
+	{
+		std::cerr << "usage: AssetPacker [--lz4] <out.vpak> <file>..." << std::endl;
+		return 1;
+	}
+	if (SDL_Init(0) != 0 || (IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG | IMG_INIT_TIF | IMG_INIT_WEBP) & IMG_INIT_PNG) == 0)
+	{
+		std::cerr << "SDL: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+	bool result = true;
+	for (std::size_t i = 1; i < args.size(); ++i)
+	{
+		std::string name = args[i];
+		std::replace(name.begin(), name.end(), '\\', '/');
+		result &= IsImage(name) ? AddImage(writer, name, args[i]) : AddRaw(writer, name, args[i]);
+	}
+	if (result && !writer.write(args[0]))
+	{
+		std::cerr << args[0] << ": cannot write (or duplicate name)" << std::endl;
+		result = false;
+	}
+	IMG_Quit();
+	SDL_Quit();
+	return result ? 0 : 1;
+}